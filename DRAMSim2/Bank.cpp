@@ -38,7 +38,9 @@ using namespace std;
 using namespace DRAMSim;
 
 Bank::Bank():
-		rowEntries(NUM_COLS)
+		rowEntries(NUM_COLS),
+		numRowNodes(0),
+		numDataBlocks(0)
 {}
 
 /* The bank class is just a glorified sparse storage data structure
@@ -124,10 +126,19 @@ void Bank::write(const BusPacket *busPacket)
 		newRowNode->data = busPacket->data;
 		newRowNode->next = rowHeadNode;
 		rowEntries[busPacket->column] = newRowNode;
+		numRowNodes++;
+		if (busPacket->data != NULL)
+		{
+			numDataBlocks++;
+		}
 	}
 	else
 	{
 		// found it, just plaster in the new data
+		if (foundNode->data == NULL && busPacket->data != NULL)
+		{
+			numDataBlocks++;
+		}
 		foundNode->data = busPacket->data;
 		if (DEBUG_BANKS)
 		{
@@ -139,3 +150,9 @@ void Bank::write(const BusPacket *busPacket)
 	delete(busPacket);
 }
 
+uint64_t Bank::getMemoryUsage() const
+{
+	return rowEntries.capacity() * sizeof(DataStruct *)
+		+ numRowNodes * sizeof(DataStruct)
+		+ numDataBlocks * BL * JEDEC_DATA_BUS_WIDTH;
+}
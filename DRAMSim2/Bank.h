@@ -55,6 +55,8 @@ public:
 	Bank();
 	void read(BusPacket *busPacket);
 	void write(const BusPacket *busPacket);
+	// bytes held by the row lists and the data they point to
+	uint64_t getMemoryUsage() const;
 
 	//fields
 	BankState currentState;
@@ -62,6 +64,8 @@ public:
 private:
 	// private member
 	std::vector<DataStruct *> rowEntries;
+	uint64_t numRowNodes;
+	uint64_t numDataBlocks;
 
 	static DataStruct *searchForRow(uint row, DataStruct *head);
 };
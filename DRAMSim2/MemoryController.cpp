@@ -38,6 +38,7 @@ int SHOW_SIM_OUTPUT = 0;
 MemoryController::MemoryController(MemorySystem *parent, std::ofstream *outfile) :
 		commandQueue (CommandQueue(bankStates)),
 		poppedBusPacket(NULL),
+		latencies(HISTOGRAM_SIGNIFICANT_DIGITS),
 		totalTransactions(0),
 		channelBitWidth (dramsim_log2(NUM_CHANS)),
 		rankBitWidth (dramsim_log2(NUM_RANKS)),
@@ -1139,15 +1140,19 @@ void MemoryController::printStats(bool finalStats)
 	if (finalStats)
 	{
 		PRINT( " ---  Latency list ("<<latencies.size()<<")");
+		PRINT( "       p50: "<<latencies.getPercentile(50.0)<<" p99: "<<latencies.getPercentile(99.0)<<" p99.9: "<<latencies.getPercentile(99.9)<<" max: "<<latencies.getMax());
 		PRINT( "       [lat] : #");
 
 		(*visDataOut) << "!!HISTOGRAM_DATA"<<endl;
 
-		map<uint,uint>::iterator it; //
-		for (it=latencies.begin(); it!=latencies.end(); it++)
+		for (int i=0; i<latencies.getNumBuckets(); i++)
 		{
-			PRINT( "       ["<< it->first <<"-"<<it->first+(HISTOGRAM_BIN_SIZE-1)<<"] : "<< it->second );
-			(*visDataOut) << it->first <<"="<< it->second << endl;
+			if (latencies.getBucketCount(i) == 0)
+			{
+				continue;
+			}
+			PRINT( "       ["<< latencies.getBucketLow(i) <<"-"<<latencies.getBucketHigh(i)<<"] : "<< latencies.getBucketCount(i) );
+			(*visDataOut) << latencies.getBucketLow(i) <<"="<< latencies.getBucketCount(i) << endl;
 		}
 
 		PRINT( " ---  Bank usage list");
@@ -1180,6 +1185,5 @@ MemoryController::~MemoryController()
 void MemoryController::insertHistogram(uint latencyValue, uint rank, uint bank)
 {
 	totalEpochLatency[SEQUENTIAL(rank,bank)] += latencyValue;
-	//poor man's way to bin things.
-	latencies[(latencyValue/HISTOGRAM_BIN_SIZE)*HISTOGRAM_BIN_SIZE]++;
+	latencies.add(latencyValue);
 }
@@ -41,6 +41,7 @@
 #include "BusPacket.h"
 #include "BankState.h"
 #include "Rank.h"
+#include "HdrHistogram.h"
 #include <map>
 
 using namespace std;
@@ -84,7 +85,7 @@ private:
 	vector<uint> writeDataCountdown;
 	vector<Transaction> returnTransaction;
 	vector<Transaction> pendingReadTransactions;
-	map<uint,uint> latencies; // latencyValue -> latencyCount
+	HdrHistogram latencies; // read latency, log-linear buckets
 	vector<bool> powerDown;
 
 	vector<Rank> *ranks;
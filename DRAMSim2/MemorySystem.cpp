@@ -367,6 +367,22 @@ void MemorySystem::printStats(bool)
 	printStats();
 }
 
+//bytes of simulated memory contents held by the banks, plus the
+//transactions still waiting to enter the controller
+uint64_t MemorySystem::getMemoryUsage() const
+{
+	uint64_t bytes = pendingTransactions.size() * sizeof(Transaction);
+	for (size_t r=0; r<ranks->size(); r++)
+	{
+		const vector<Bank> &banks = (*ranks)[r].banks;
+		for (size_t b=0; b<banks.size(); b++)
+		{
+			bytes += banks[b].getMemoryUsage();
+		}
+	}
+	return bytes;
+}
+
 
 //update the memory systems state
 void MemorySystem::update()
@@ -51,6 +51,7 @@ public:
 	bool addTransaction(bool isWrite, uint64_t addr);
 	void printStats();
 	void printStats(bool unused);
+	uint64_t getMemoryUsage() const;
 	bool WillAcceptTransaction();
 	string SetOutputFileName(string tracefilename);
 	void RegisterCallbacks(
@@ -38,9 +38,9 @@
 
 
 
-//number of latencies per bucket in the latency histogram
+//significant decimal digits kept by the latency histogram
 //TODO: move to system ini file
-#define HISTOGRAM_BIN_SIZE 10
+#define HISTOGRAM_SIGNIFICANT_DIGITS 2
 
 extern std::ofstream cmd_verify_out; //used by BusPacket.cpp if VERIFICATION_OUTPUT is enabled
 //extern std::ofstream visDataOut;
@@ -192,7 +192,14 @@ namespace __gnu_cxx {
   template<>
   struct hash<Address>
   {
-    size_t operator()(const Address &s) const { return (size_t) s.getAddress(); }
+    // Most keys are block aligned, so rotate the always-zero offset bits
+    // to the top instead of hashing them; the fold keeps 32-bit hosts
+    // from discarding the high bits.
+    size_t operator()(const Address &s) const {
+      physical_address_t a = s.getAddress();
+      physical_address_t r = (a >> DATA_BLOCK_BITS) | (a << (ADDRESS_WIDTH - DATA_BLOCK_BITS));
+      return (size_t) (r ^ (r >> 32));
+    }
   };
 }
 namespace std {
@@ -35,29 +35,45 @@
 #define ALLOCATOR_H
 
 #include "Vector.h"
+#include "HostMemory.h"
+
+// Pool of TYPE objects.  Objects are carved out of slabs of
+// ALLOCATOR_SLAB_SIZE default-constructed objects, so a generated
+// message or entry type costs one malloc per slab rather than one per
+// object, and objects of one type stay close together in memory.
+// Released objects go on a free list and are reused by assignment.
+// Slabs are charged to a HostMemory subsystem, HOST_MEMORY_POOLS
+// unless the pool is given another tag.
+
+const int ALLOCATOR_SLAB_SIZE = 64;
 
 template <class TYPE>
 class Allocator {
 public:
   // Constructors
-  Allocator() { m_counter = 0; }
+  explicit Allocator(HostMemoryTag tag = HOST_MEMORY_POOLS) { m_counter = 0; m_tag = tag; }
 
   // Destructor
-  ~Allocator() { for(int i=0; i<m_pool_vec.size(); i++) { delete m_pool_vec[i]; }}
+  ~Allocator() { for(int i=0; i<m_slab_vec.size(); i++) { host_delete_array(m_tag, m_slab_vec[i], ALLOCATOR_SLAB_SIZE); }}
   
   // Public Methods
   TYPE* allocate(const TYPE& obj);
   void deallocate(TYPE* obj_ptr);
+  int numAllocated() const { return m_slab_vec.size() * ALLOCATOR_SLAB_SIZE; }
+  int numInUse() const { return numAllocated() - m_pool_vec.size(); }
 private:
   // Private copy constructor and assignment operator
   Allocator(const Allocator& obj);
   Allocator& operator=(const Allocator& obj);
 
   // Private Methods
+  void addSlab();
 
   // Data Members (m_ prefix)
-  Vector<TYPE*> m_pool_vec;
+  Vector<TYPE*> m_slab_vec;  // every slab ever allocated
+  Vector<TYPE*> m_pool_vec;  // free objects
   int m_counter;
+  HostMemoryTag m_tag;
 };
 
 template <class TYPE> 
@@ -70,8 +86,7 @@ TYPE* Allocator<TYPE>::allocate(const TYPE& obj)
   
   // See if we need to allocate any new objects
   if (m_pool_vec.size() == 0) {
-    // Allocate a new item
-    m_pool_vec.insertAtBottom(new TYPE);
+    addSlab();
   }
 
   // Pop the pointer from the stack/pool
@@ -91,4 +106,15 @@ void Allocator<TYPE>::deallocate(TYPE* obj)
   m_pool_vec.insertAtBottom(obj);
 }
 
+template <class TYPE> 
+void Allocator<TYPE>::addSlab()
+{ 
+  TYPE* slab = host_new_array<TYPE>(m_tag, ALLOCATOR_SLAB_SIZE);
+  m_slab_vec.insertAtBottom(slab);
+  // Push in reverse so objects are handed out in address order
+  for (int i = ALLOCATOR_SLAB_SIZE-1; i >= 0; i--) {
+    m_pool_vec.insertAtBottom(&slab[i]);
+  }
+}
+
 #endif //ALLOCATOR_H
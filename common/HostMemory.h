@@ -0,0 +1,151 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+// HostMemory breaks the simulator's own (host) memory use down by
+// subsystem, to size jobs and to spot structures that grow without
+// bound.  Two kinds of numbers are combined per subsystem:
+//
+//   - tracked bytes: objects created through host_new()/host_new_array()
+//     (and the Allocator slab pools) are counted as they are created
+//     and destroyed;
+//   - reported bytes: large containers implement HostMemoryReporter
+//     and tell HostMemory::collect() their current footprint.
+//
+// A subsystem's size is the sum of the two, so a reporter must not
+// count objects that are already tracked.  Reported sizes are
+// estimates of the payload (allocator overhead is not included); the
+// peak and current resident set size of the whole process are read
+// from /proc/self/status for comparison.
+
+#ifndef HOSTMEMORY_H
+#define HOSTMEMORY_H
+
+#include "Global.h"
+
+enum HostMemoryTag {
+  HOST_MEMORY_OTHER,
+  HOST_MEMORY_POOLS,            // Allocator slabs of generated message and entry types
+  HOST_MEMORY_DIRECTORY,        // DirectoryMemory entry arrays and entries
+  HOST_MEMORY_DRAM,             // DRAMSim2 bank data lists and queues
+  HOST_MEMORY_PROFILER,         // Ruby Profiler histograms and maps
+  HOST_MEMORY_ADDRESS_PROFILER, // AddressProfiler tables and their records
+  HOST_MEMORY_RECORDER,         // CacheRecorder records
+  HOST_MEMORY_LSQ,              // pyrite load/store queues
+  HOST_MEMORY_CODE_MAP,         // g_code_map disassembly strings
+  HOST_MEMORY_NUM
+};
+
+struct HostMemoryCounters {
+  int64 m_tracked[HOST_MEMORY_NUM];   // live bytes from host_new() and friends
+  int64 m_reported[HOST_MEMORY_NUM];  // as of the last collect()
+  int64 m_peak[HOST_MEMORY_NUM];      // largest tracked + reported seen
+};
+
+extern HostMemoryCounters g_host_memory;
+
+extern inline
+void host_memory_allocated(HostMemoryTag tag, int64 bytes)
+{
+  g_host_memory.m_tracked[tag] += bytes;
+  int64 total = g_host_memory.m_tracked[tag] + g_host_memory.m_reported[tag];
+  if (total > g_host_memory.m_peak[tag]) {
+    g_host_memory.m_peak[tag] = total;
+  }
+}
+
+extern inline
+void host_memory_freed(HostMemoryTag tag, int64 bytes)
+{
+  g_host_memory.m_tracked[tag] -= bytes;
+}
+
+// new/delete wrappers that charge the object to a subsystem.  The tag
+// (and for arrays the count) given to the delete must match the new.
+template <class TYPE>
+extern inline
+TYPE* host_new(HostMemoryTag tag)
+{
+  host_memory_allocated(tag, sizeof(TYPE));
+  return new TYPE;
+}
+
+template <class TYPE>
+extern inline
+void host_delete(HostMemoryTag tag, TYPE* ptr)
+{
+  if (ptr != NULL) {
+    host_memory_freed(tag, sizeof(TYPE));
+    delete ptr;
+  }
+}
+
+template <class TYPE>
+extern inline
+TYPE* host_new_array(HostMemoryTag tag, int64 count)
+{
+  host_memory_allocated(tag, count * sizeof(TYPE));
+  return new TYPE[count];
+}
+
+template <class TYPE>
+extern inline
+void host_delete_array(HostMemoryTag tag, TYPE* ptr, int64 count)
+{
+  if (ptr != NULL) {
+    host_memory_freed(tag, count * sizeof(TYPE));
+    delete [] ptr;
+  }
+}
+
+// Base class of the containers that report their own size.  Objects
+// register on construction and unregister on destruction.
+class HostMemoryReporter {
+public:
+  HostMemoryReporter();
+  HostMemoryReporter(const HostMemoryReporter& obj);
+  virtual ~HostMemoryReporter();
+  HostMemoryReporter& operator=(const HostMemoryReporter& obj) { return *this; }
+
+  // call HostMemory::report() for what this object holds right now
+  virtual void reportHostMemory() const = 0;
+};
+
+class HostMemory {
+public:
+  // ask every HostMemoryReporter for its current size
+  static void collect();
+  // only called from HostMemoryReporter::reportHostMemory()
+  static void report(HostMemoryTag tag, int64 bytes);
+
+  // tracked plus reported bytes, as of the last collect()
+  static int64 getBytes(HostMemoryTag tag);
+  static int64 getPeakBytes(HostMemoryTag tag);
+  static int64 getTotalBytes();
+  static const char* getName(HostMemoryTag tag);
+
+  // VmHWM and VmRSS of this process in bytes, 0 if unavailable
+  static int64 getPeakRss();
+  static int64 getRss();
+
+  // bytes per subsystem next to the process RSS; collects first
+  static void print(ostream& out);
+};
+
+#endif //HOSTMEMORY_H
@@ -0,0 +1,111 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+// HostProfiler attributes the host time of a run to the simulator's
+// subsystems.  HOST_PROFILE_SCOPE(category) marks a block; on entry
+// and exit the time stamp counter is read and the ticks since the
+// previous switch are charged to the category that was running, so
+// nested scopes count exclusive ("self") time.  Time outside of any
+// scope goes to HOST_PROFILE_OTHER.
+//
+// The counters are thread-local; the scopes all sit on the simulation
+// thread, which is the one that reports.  Scopes compile to nothing
+// unless HOST_PROFILING is defined (scons host_profiling=1).
+
+#ifndef HOSTPROFILER_H
+#define HOSTPROFILER_H
+
+#include "Global.h"
+
+enum HostProfileCategory {
+  HOST_PROFILE_OTHER,        // outside every scope, e.g. Simics itself
+  HOST_PROFILE_SIMICS,       // stepping Simics and reading its state
+  HOST_PROFILE_DECODE,       // x86 -> uop translation
+  HOST_PROFILE_FETCH,
+  HOST_PROFILE_RENAME,
+  HOST_PROFILE_EXECUTE,
+  HOST_PROFILE_RETIRE,
+  HOST_PROFILE_RUBY_EVENTS,  // the Ruby event queue itself
+  HOST_PROFILE_CONTROLLERS,  // SLICC controller wakeups
+  HOST_PROFILE_NETWORK,      // switches and throttles
+  HOST_PROFILE_DRAM,         // DRAMSim2 updates
+  HOST_PROFILE_NUM
+};
+
+struct HostProfileCounters {
+  uint64 m_ticks[HOST_PROFILE_NUM];
+  uint64 m_last_tsc;               // when the running category last changed
+  HostProfileCategory m_current;
+};
+
+extern __thread HostProfileCounters g_host_profile;
+
+extern inline
+uint64 host_profile_tsc()
+{
+  uint32 low, high;
+  __asm__ __volatile__("rdtsc" : "=a" (low), "=d" (high));
+  return (uint64(high) << 32) | low;
+}
+
+class HostProfileScope {
+public:
+  explicit HostProfileScope(HostProfileCategory category)
+  {
+    m_outer = g_host_profile.m_current;
+    switchTo(category);
+  }
+  ~HostProfileScope() { switchTo(m_outer); }
+
+private:
+  static void switchTo(HostProfileCategory category)
+  {
+    uint64 now = host_profile_tsc();
+    g_host_profile.m_ticks[g_host_profile.m_current] += now - g_host_profile.m_last_tsc;
+    g_host_profile.m_last_tsc = now;
+    g_host_profile.m_current = category;
+  }
+
+  HostProfileCategory m_outer;
+};
+
+#ifdef HOST_PROFILING
+#define HOST_PROFILE_SCOPE(category) HostProfileScope host_profile_scope(category)
+#else
+#define HOST_PROFILE_SCOPE(category)
+#endif
+
+class HostProfiler {
+public:
+  static bool isEnabled();
+  // zero every counter and restart the wall clock
+  static void reset();
+  // ticks charged to category since the last reset
+  static uint64 getTicks(HostProfileCategory category);
+  static uint64 getTotalTicks();
+  // wall clock time since the last reset
+  static uint64 getNanoseconds();
+  static const char* getName(HostProfileCategory category);
+
+  // percent of host time and host ns per simulated cycle, by category
+  static void print(ostream& out, int64 simulated_cycles);
+};
+
+#endif //HOSTPROFILER_H
@@ -38,24 +38,38 @@ namespace __gnu_cxx {
   };
 }
 
+// Map is an open-addressing hash table using robin-hood probing with
+// backward-shift deletion.  Keys live in one flat slot array so that
+// probes do not chase pointers.  Values live in fixed-size chunks that
+// never move, so a reference returned by lookup() stays valid until
+// its key is erased (the same guarantee hash_map gave).  Erased value
+// slots are recycled, so steady-state add/erase does not allocate.
+//
+// Keys are hashed with __gnu_cxx::hash<KEY_TYPE> followed by a
+// Fibonacci multiply, so weak hashes (identity on addresses or
+// pointers) still spread across the table.
+
 template <class KEY_TYPE, class VALUE_TYPE> 
 class Map
 {
 public:
-  Map() { /* empty */ }
-  ~Map() { /* empty */ }
+  Map() { init(); }
+  ~Map() { destroy(); }
   
   void add(const KEY_TYPE& key, const VALUE_TYPE& value);
-  bool exist(const KEY_TYPE& key) const;
-  int size() const { return m_map.size(); }
-  void erase(const KEY_TYPE& key) { assert(exist(key)); m_map.erase(key); }
+  bool exist(const KEY_TYPE& key) const { return findSlot(key) != -1; }
+  int size() const { return m_size; }
+  void erase(const KEY_TYPE& key);
   Vector<KEY_TYPE> keys() const;
   Vector<VALUE_TYPE> values() const;
   void deleteKeys();
   void deleteValues();
   VALUE_TYPE& lookup(const KEY_TYPE& key) const; 
-  void clear() { m_map.clear(); }
+  void clear() { destroy(); init(); }
   void print(ostream& out) const;
+  // bytes of the slot array and value chunks, not counting anything
+  // the keys or values point to
+  size_t getMemoryUsage() const;
 
   // Synonyms
   void remove(const KEY_TYPE& key) { erase(key); } 
@@ -63,14 +77,38 @@ public:
   void allocate(const KEY_TYPE& key) { add(key, VALUE_TYPE()); }
   void insert(const KEY_TYPE& key, const VALUE_TYPE& value) { add(key, value); }
 
-  // Use default copy constructor and assignment operator
+  // Public copy constructor and assignment operator
+  Map(const Map& obj) { init(); *this = obj; }
+  Map<KEY_TYPE, VALUE_TYPE>& operator=(const Map& obj);
+
 private:
+  enum { VALUE_CHUNK_BITS = 4, VALUE_CHUNK = 1 << VALUE_CHUNK_BITS, MIN_CAPACITY_BITS = 4 };
+
+  struct Slot {
+    KEY_TYPE m_key;
+    int m_value;          // index into the value chunks
+    unsigned m_distance;  // 0 when empty, otherwise 1 + distance from home slot
+  };
+
+  // Private Methods
+  void init();
+  void destroy();
+  int homeSlot(const KEY_TYPE& key) const;
+  int findSlot(const KEY_TYPE& key) const;  // -1 if not present
+  void insertSlot(Slot carry);
+  void grow();
+  int allocateValue();
+  VALUE_TYPE& valueRef(int index) const { return m_chunks[index >> VALUE_CHUNK_BITS][index & (VALUE_CHUNK - 1)]; }
+
   // Data members
+  Slot* m_slots;
+  int m_capacity_bits;
+  int m_capacity;
+  int m_size;
 
-  // m_map is declared mutable because some methods from the STL "map"
-  // class that should be const are not.  Thus we define this as
-  // mutable so we can still have conceptually const accessors.
-  mutable hash_map<KEY_TYPE, VALUE_TYPE> m_map;
+  Vector<VALUE_TYPE*> m_chunks;
+  Vector<int> m_free_values;
+  int m_num_values;
 };
 
 template <class KEY_TYPE, class VALUE_TYPE>
@@ -92,34 +130,187 @@ extern inline string str(const Map<KEY_TYPE, VALUE_TYPE>& obj)
 
 // *********************
 
+template <class KEY_TYPE, class VALUE_TYPE> 
+void Map<KEY_TYPE, VALUE_TYPE>::init()
+{
+  // an empty map allocates nothing until the first add
+  m_slots = NULL;
+  m_capacity_bits = 0;
+  m_capacity = 0;
+  m_size = 0;
+  m_num_values = 0;
+}
+
+template <class KEY_TYPE, class VALUE_TYPE> 
+void Map<KEY_TYPE, VALUE_TYPE>::destroy()
+{
+  delete [] m_slots;
+  for (int i = 0; i < m_chunks.size(); i++) {
+    delete [] m_chunks[i];
+  }
+  m_chunks.clear();
+  m_free_values.clear();
+}
+
+template <class KEY_TYPE, class VALUE_TYPE> 
+Map<KEY_TYPE, VALUE_TYPE>& Map<KEY_TYPE, VALUE_TYPE>::operator=(const Map& obj)
+{
+  if (this != &obj) {
+    clear();
+    for (int i = 0; i < obj.m_capacity; i++) {
+      if (obj.m_slots[i].m_distance != 0) {
+        add(obj.m_slots[i].m_key, obj.valueRef(obj.m_slots[i].m_value));
+      }
+    }
+  }
+  return *this;
+}
+
+template <class KEY_TYPE, class VALUE_TYPE> 
+int Map<KEY_TYPE, VALUE_TYPE>::homeSlot(const KEY_TYPE& key) const
+{
+  unsigned long long hash = (unsigned long long) __gnu_cxx::hash<KEY_TYPE>()(key);
+  return (int) ((hash * 0x9E3779B97F4A7C15ULL) >> (64 - m_capacity_bits));
+}
+
+template <class KEY_TYPE, class VALUE_TYPE> 
+int Map<KEY_TYPE, VALUE_TYPE>::findSlot(const KEY_TYPE& key) const
+{
+  if (m_size == 0) {
+    return -1;
+  }
+  int mask = m_capacity - 1;
+  int pos = homeSlot(key);
+  // robin-hood invariant: once we pass an entry closer to its home
+  // than we are to ours, the key cannot be further along
+  for (unsigned distance = 1; m_slots[pos].m_distance >= distance; distance++) {
+    if (m_slots[pos].m_key == key) {
+      return pos;
+    }
+    pos = (pos + 1) & mask;
+  }
+  return -1;
+}
+
+template <class KEY_TYPE, class VALUE_TYPE> 
+void Map<KEY_TYPE, VALUE_TYPE>::insertSlot(Slot carry)
+{
+  int mask = m_capacity - 1;
+  int pos = homeSlot(carry.m_key);
+  carry.m_distance = 1;
+  while (m_slots[pos].m_distance != 0) {
+    if (m_slots[pos].m_distance < carry.m_distance) {
+      // steal from the rich: the resident is closer to home than we are
+      Slot temp = m_slots[pos];
+      m_slots[pos] = carry;
+      carry = temp;
+    }
+    pos = (pos + 1) & mask;
+    carry.m_distance++;
+  }
+  m_slots[pos] = carry;
+}
+
+template <class KEY_TYPE, class VALUE_TYPE> 
+void Map<KEY_TYPE, VALUE_TYPE>::grow()
+{
+  Slot* old_slots = m_slots;
+  int old_capacity = m_capacity;
+
+  m_capacity_bits = (m_capacity_bits == 0) ? int(MIN_CAPACITY_BITS) : (m_capacity_bits + 1);
+  m_capacity = 1 << m_capacity_bits;
+  m_slots = new Slot[m_capacity];
+  for (int i = 0; i < m_capacity; i++) {
+    m_slots[i].m_distance = 0;
+  }
+
+  // only keys and value indices move; the values themselves stay put
+  for (int i = 0; i < old_capacity; i++) {
+    if (old_slots[i].m_distance != 0) {
+      insertSlot(old_slots[i]);
+    }
+  }
+  delete [] old_slots;
+}
+
+template <class KEY_TYPE, class VALUE_TYPE> 
+int Map<KEY_TYPE, VALUE_TYPE>::allocateValue()
+{
+  if (m_free_values.size() != 0) {
+    int index = m_free_values[m_free_values.size() - 1];
+    m_free_values.setSize(m_free_values.size() - 1);
+    return index;
+  }
+  if ((m_num_values & (VALUE_CHUNK - 1)) == 0) {
+    m_chunks.insertAtBottom(new VALUE_TYPE[VALUE_CHUNK]);
+  }
+  return m_num_values++;
+}
+
 template <class KEY_TYPE, class VALUE_TYPE> 
 void Map<KEY_TYPE, VALUE_TYPE>::add(const KEY_TYPE& key, const VALUE_TYPE& value)
 { 
   // Update or add a new key/value pair
-  m_map[key] = value;
+  int pos = findSlot(key);
+  if (pos != -1) {
+    valueRef(m_slots[pos].m_value) = value;
+    return;
+  }
+
+  // keep the load factor at or below 7/8
+  if ((m_size + 1) * 8 > m_capacity * 7) {
+    grow();
+  }
+
+  Slot carry;
+  carry.m_key = key;
+  carry.m_value = allocateValue();
+  valueRef(carry.m_value) = value;
+  insertSlot(carry);
+  m_size++;
 }
 
 template <class KEY_TYPE, class VALUE_TYPE> 
-bool Map<KEY_TYPE, VALUE_TYPE>::exist(const KEY_TYPE& key) const
+void Map<KEY_TYPE, VALUE_TYPE>::erase(const KEY_TYPE& key)
 {
-  return (m_map.count(key) != 0);
+  int pos = findSlot(key);
+  assert(pos != -1);
+
+  // release whatever the value holds and recycle its storage
+  valueRef(m_slots[pos].m_value) = VALUE_TYPE();
+  m_free_values.insertAtBottom(m_slots[pos].m_value);
+
+  // backward-shift the following cluster instead of leaving a tombstone
+  int mask = m_capacity - 1;
+  int next = (pos + 1) & mask;
+  while (m_slots[next].m_distance > 1) {
+    m_slots[pos] = m_slots[next];
+    m_slots[pos].m_distance--;
+    pos = next;
+    next = (next + 1) & mask;
+  }
+  m_slots[pos].m_key = KEY_TYPE();
+  m_slots[pos].m_distance = 0;
+  m_size--;
 }
 
 template <class KEY_TYPE, class VALUE_TYPE> 
 VALUE_TYPE& Map<KEY_TYPE, VALUE_TYPE>::lookup(const KEY_TYPE& key) const
 {
+  int pos = findSlot(key);
 //  assert_msg(exist(key), key);
-  assert(exist(key));
-  return m_map[key];
+  assert(pos != -1);
+  return valueRef(m_slots[pos].m_value);
 }
 
 template <class KEY_TYPE, class VALUE_TYPE> 
 Vector<KEY_TYPE> Map<KEY_TYPE, VALUE_TYPE>::keys() const
 {
   Vector<KEY_TYPE> keys;
-  typename hash_map<KEY_TYPE, VALUE_TYPE>::const_iterator iter;
-  for (iter = m_map.begin(); iter != m_map.end(); iter++) {
-    keys.insertAtBottom((*iter).first);
+  for (int i = 0; i < m_capacity; i++) {
+    if (m_slots[i].m_distance != 0) {
+      keys.insertAtBottom(m_slots[i].m_key);
+    }
   }
   return keys;
 }
@@ -128,12 +319,10 @@ template <class KEY_TYPE, class VALUE_TYPE>
 Vector<VALUE_TYPE> Map<KEY_TYPE, VALUE_TYPE>::values() const
 {
   Vector<VALUE_TYPE> values;
-  typename hash_map<KEY_TYPE, VALUE_TYPE>::const_iterator iter;
-  pair<KEY_TYPE, VALUE_TYPE> p;
-  
-  for (iter = m_map.begin(); iter != m_map.end(); iter++) {
-    p = *iter;
-    keys.insertAtBottom(p.second);
+  for (int i = 0; i < m_capacity; i++) {
+    if (m_slots[i].m_distance != 0) {
+      values.insertAtBottom(valueRef(m_slots[i].m_value));
+    }
   }
   return values;
 }
@@ -141,38 +330,39 @@ Vector<VALUE_TYPE> Map<KEY_TYPE, VALUE_TYPE>::values() const
 template <class KEY_TYPE, class VALUE_TYPE> 
 void Map<KEY_TYPE, VALUE_TYPE>::deleteKeys()
 {
-  typename hash_map<KEY_TYPE, VALUE_TYPE>::const_iterator iter;
-  pair<KEY_TYPE, VALUE_TYPE> p;
-  
-  for (iter = m_map.begin(); iter != m_map.end(); iter++) {
-    p = *iter;
-    delete p.first;
+  for (int i = 0; i < m_capacity; i++) {
+    if (m_slots[i].m_distance != 0) {
+      delete m_slots[i].m_key;
+    }
   }
 }
 
 template <class KEY_TYPE, class VALUE_TYPE> 
 void Map<KEY_TYPE, VALUE_TYPE>::deleteValues()
 {
-  typename hash_map<KEY_TYPE, VALUE_TYPE>::const_iterator iter;
-  pair<KEY_TYPE, VALUE_TYPE> p;
-  
-  for (iter = m_map.begin(); iter != m_map.end(); iter++) {
-    p = *iter;
-    delete p.second;
+  for (int i = 0; i < m_capacity; i++) {
+    if (m_slots[i].m_distance != 0) {
+      delete valueRef(m_slots[i].m_value);
+    }
   }
 }
 
+template <class KEY_TYPE, class VALUE_TYPE> 
+size_t Map<KEY_TYPE, VALUE_TYPE>::getMemoryUsage() const
+{
+  return size_t(m_capacity) * sizeof(Slot)
+    + size_t(m_chunks.size()) * VALUE_CHUNK * sizeof(VALUE_TYPE)
+    + m_chunks.getMemoryUsage() + m_free_values.getMemoryUsage();
+}
+
 template <class KEY_TYPE, class VALUE_TYPE> 
 void Map<KEY_TYPE, VALUE_TYPE>::print(ostream& out) const
 {
-  typename hash_map<KEY_TYPE, VALUE_TYPE>::const_iterator iter;
-  pair<KEY_TYPE, VALUE_TYPE> p;
-  
   out << "[";
-  for (iter = m_map.begin(); iter != m_map.end(); iter++) {
-    // unparse each basic block
-    p = *iter;
-    out << " " << p.first << "=" << p.second;
+  for (int i = 0; i < m_capacity; i++) {
+    if (m_slots[i].m_distance != 0) {
+      out << " " << m_slots[i].m_key << "=" << valueRef(m_slots[i].m_value);
+    }
   }
   out << " ]";
 }
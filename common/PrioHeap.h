@@ -55,6 +55,7 @@ public:
   const TYPE& peekElement(int index) const;
   TYPE extractMin();
   void print(ostream& out) const;
+  int64 getMemoryUsage() const { return m_heap.getMemoryUsage(); }
 private:
   // Private Methods
   bool verifyHeap() const;
@@ -47,6 +47,7 @@ public:
   // Public Methods
   const TYPE* ref() const { return m_data_ptr; }
   TYPE* ref() { return m_data_ptr; }
+  TYPE* writableRef();  // copy-on-write: private copy if shared
   void freeRef();
   void print(ostream& out) const;
 
@@ -104,6 +105,21 @@ void RefCnt<TYPE>::freeRef()
   }
 }
 
+// Returns a pointer that may be modified without affecting any other
+// holder of the object, cloning it first only if it is shared
+template <class TYPE> 
+inline
+TYPE* RefCnt<TYPE>::writableRef() 
+{ 
+  if (m_data_ptr != NULL && m_data_ptr->getRefCnt() > 1) {
+    TYPE* copy_ptr = m_data_ptr->clone();
+    copy_ptr->setRefCnt(1);
+    m_data_ptr->decRefCnt();
+    m_data_ptr = copy_ptr;
+  }
+  return m_data_ptr;
+}
+
 template <class TYPE> 
 inline
 void RefCnt<TYPE>::print(ostream& out) const 
@@ -0,0 +1,325 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+// StatHashtable is the uint64 -> int64 counter table behind the
+// STAT_HASHTABLE statistics generated by gendef.py.  Keys and counts
+// sit side by side in one flat, linearly probed slot array, and
+// incrementN() finds or inserts its key in a single probe sequence.
+// Nothing is ever erased on its own, so there are no tombstones.
+//
+// The slot array marks empty slots with the key EMPTY_KEY; that key
+// itself is counted outside the array so that every uint64 is usable.
+//
+// With max_entries == 0 the table grows without bound.  Otherwise it
+// keeps at most max_entries keys: when a new key arrives and the table
+// is full, the half of the keys with the smallest counts is dropped
+// (top-K eviction).  Pruning in bulk keeps the cost per new key
+// constant.  The count of a key that is present covers the events
+// since it was last admitted, and every dropped key had a count of at
+// most getMaxError() when it was dropped.
+
+#ifndef STATHASHTABLE_H
+#define STATHASHTABLE_H
+
+#include <algorithm>
+#include "Global.h"
+#include "Vector.h"
+
+class StatHashtable {
+public:
+  // Constructors
+  // max_entries == 0 keeps a count for every key
+  explicit StatHashtable(int max_entries = 0);
+
+  // Destructor
+  ~StatHashtable() { delete [] m_slots; }
+
+  // Public Methods
+
+  // adds n to the count of key, which starts at initial when key is new
+  void incrementN(uint64 key, int64 n, int64 initial) { findOrInsert(key, initial) += n; }
+  void set(uint64 key, int64 value) { findOrInsert(key, value) = value; }
+  bool exist(uint64 key) const { return findSlot(key) != NULL; }
+  // count of key, or missing if it has none
+  int64 lookup(uint64 key, int64 missing = 0) const;
+  Vector<uint64> keys() const;
+  void clear();
+
+  int size() const { return m_size + (m_has_empty_key ? 1 : 0); }
+  bool isBounded() const { return m_max_entries > 0; }
+  int getMaxEntries() const { return m_max_entries; }
+  uint64 getEvictions() const { return m_evictions; }
+  int64 getMaxError() const { return m_max_error; }
+
+  void print(ostream& out) const;
+private:
+  static const uint64 EMPTY_KEY = ~0ULL;
+  enum { MIN_CAPACITY_BITS = 4 };
+
+  struct Slot {
+    uint64 m_key;     // EMPTY_KEY when the slot is free
+    int64 m_count;
+  };
+
+  // Private Methods
+  int homeSlot(uint64 key) const { return (int) ((key * 0x9E3779B97F4A7C15ULL) >> (64 - m_capacity_bits)); }
+  Slot* findSlot(uint64 key) const;
+  int64& findOrInsert(uint64 key, int64 initial);
+  int64& insertNew(uint64 key, int64 initial);
+  void rehash(int capacity_bits);
+  void prune();
+
+  // Private copy constructor and assignment operator
+  StatHashtable(const StatHashtable& obj);
+  StatHashtable& operator=(const StatHashtable& obj);
+
+  // Data Members (m_ prefix)
+  Slot* m_slots;
+  int m_capacity_bits;
+  int m_capacity;
+  int m_size;             // keys in m_slots
+
+  bool m_has_empty_key;   // EMPTY_KEY is counted here, not in m_slots
+  int64 m_empty_key_count;
+
+  int m_max_entries;
+  uint64 m_evictions;
+  int64 m_max_error;
+};
+
+// Output operator declaration
+ostream& operator<<(ostream& out, const StatHashtable& obj);
+
+// ******************* Definitions *******************
+
+inline
+StatHashtable::StatHashtable(int max_entries)
+{
+  assert(max_entries >= 0);
+  m_slots = NULL;
+  m_max_entries = max_entries;
+  clear();
+}
+
+inline
+void StatHashtable::clear()
+{
+  // a bounded table is sized once so that it never grows
+  int capacity_bits = MIN_CAPACITY_BITS;
+  while (isBounded() && (1 << capacity_bits) < 2 * m_max_entries) {
+    capacity_bits++;
+  }
+  delete [] m_slots;
+  m_slots = NULL;
+  m_size = 0;
+  rehash(capacity_bits);
+  m_has_empty_key = false;
+  m_empty_key_count = 0;
+  m_evictions = 0;
+  m_max_error = 0;
+}
+
+inline
+StatHashtable::Slot* StatHashtable::findSlot(uint64 key) const
+{
+  if (key == EMPTY_KEY) {
+    return NULL;
+  }
+  int mask = m_capacity - 1;
+  for (int pos = homeSlot(key); m_slots[pos].m_key != EMPTY_KEY; pos = (pos + 1) & mask) {
+    if (m_slots[pos].m_key == key) {
+      return &m_slots[pos];
+    }
+  }
+  return NULL;
+}
+
+inline
+int64 StatHashtable::lookup(uint64 key, int64 missing) const
+{
+  if (key == EMPTY_KEY) {
+    return m_has_empty_key ? m_empty_key_count : missing;
+  }
+  Slot* slot = findSlot(key);
+  return (slot == NULL) ? missing : slot->m_count;
+}
+
+inline
+int64& StatHashtable::findOrInsert(uint64 key, int64 initial)
+{
+  if (key != EMPTY_KEY) {
+    int mask = m_capacity - 1;
+    int pos = homeSlot(key);
+    while (m_slots[pos].m_key != EMPTY_KEY) {
+      if (m_slots[pos].m_key == key) {
+        return m_slots[pos].m_count;
+      }
+      pos = (pos + 1) & mask;
+    }
+    // keep the load factor at or below 1/2; the slot found above is
+    // only stale if the table has to be grown or pruned first
+    if ((isBounded() && size() >= m_max_entries) || (m_size + 1) * 2 > m_capacity) {
+      return insertNew(key, initial);
+    }
+    m_slots[pos].m_key = key;
+    m_slots[pos].m_count = initial;
+    m_size++;
+    return m_slots[pos].m_count;
+  }
+  return insertNew(key, initial);
+}
+
+// Slow path of findOrInsert for keys that are not present
+inline
+int64& StatHashtable::insertNew(uint64 key, int64 initial)
+{
+  if (isBounded() && size() >= m_max_entries) {
+    prune();
+  } else if ((m_size + 1) * 2 > m_capacity) {
+    rehash(m_capacity_bits + 1);
+  }
+
+  if (key == EMPTY_KEY) {
+    if (!m_has_empty_key) {
+      m_has_empty_key = true;
+      m_empty_key_count = initial;
+    }
+    return m_empty_key_count;
+  }
+  int mask = m_capacity - 1;
+  int pos = homeSlot(key);
+  while (m_slots[pos].m_key != EMPTY_KEY) {
+    pos = (pos + 1) & mask;
+  }
+  m_slots[pos].m_key = key;
+  m_slots[pos].m_count = initial;
+  m_size++;
+  return m_slots[pos].m_count;
+}
+
+inline
+void StatHashtable::rehash(int capacity_bits)
+{
+  Slot* old_slots = m_slots;
+  int old_capacity = (old_slots == NULL) ? 0 : m_capacity;
+
+  m_capacity_bits = capacity_bits;
+  m_capacity = 1 << capacity_bits;
+  m_slots = new Slot[m_capacity];
+  for (int i = 0; i < m_capacity; i++) {
+    m_slots[i].m_key = EMPTY_KEY;
+    m_slots[i].m_count = 0;
+  }
+
+  int mask = m_capacity - 1;
+  for (int i = 0; i < old_capacity; i++) {
+    if (old_slots[i].m_key != EMPTY_KEY) {
+      int pos = homeSlot(old_slots[i].m_key);
+      while (m_slots[pos].m_key != EMPTY_KEY) {
+        pos = (pos + 1) & mask;
+      }
+      m_slots[pos] = old_slots[i];
+    }
+  }
+  delete [] old_slots;
+}
+
+// Drops the smaller half of the counts, keeping the largest
+// m_max_entries / 2 keys
+inline
+void StatHashtable::prune()
+{
+  assert(isBounded());
+  Vector<int64> counts;
+  for (int i = 0; i < m_capacity; i++) {
+    if (m_slots[i].m_key != EMPTY_KEY) {
+      counts.insertAtBottom(m_slots[i].m_count);
+    }
+  }
+  if (m_has_empty_key) {
+    counts.insertAtBottom(m_empty_key_count);
+  }
+
+  // everything strictly below the threshold goes, and enough of the
+  // keys at the threshold to get down to the target size
+  int keep = m_max_entries / 2;
+  int num_drop = counts.size() - keep;
+  assert(num_drop > 0);
+  int64* begin = &counts[0];
+  std::nth_element(begin, begin + num_drop - 1, begin + counts.size());
+  int64 threshold = counts[num_drop - 1];
+  int num_below = 0;
+  for (int i = 0; i < counts.size(); i++) {
+    num_below += (counts[i] < threshold) ? 1 : 0;
+  }
+  int drop_at_threshold = num_drop - num_below;
+
+  if (m_has_empty_key && (m_empty_key_count < threshold || (m_empty_key_count == threshold && drop_at_threshold-- > 0))) {
+    m_has_empty_key = false;
+  }
+  for (int i = 0; i < m_capacity; i++) {
+    int64 count = m_slots[i].m_count;
+    if (m_slots[i].m_key != EMPTY_KEY && (count < threshold || (count == threshold && drop_at_threshold-- > 0))) {
+      m_slots[i].m_key = EMPTY_KEY;
+      m_size--;
+    }
+  }
+  m_evictions += num_drop;
+  m_max_error = max(m_max_error, threshold);
+
+  // survivors move back towards their home slots
+  rehash(m_capacity_bits);
+}
+
+inline
+Vector<uint64> StatHashtable::keys() const
+{
+  Vector<uint64> keys;
+  for (int i = 0; i < m_capacity; i++) {
+    if (m_slots[i].m_key != EMPTY_KEY) {
+      keys.insertAtBottom(m_slots[i].m_key);
+    }
+  }
+  if (m_has_empty_key) {
+    uint64 empty_key = EMPTY_KEY;
+    keys.insertAtBottom(empty_key);
+  }
+  return keys;
+}
+
+inline
+void StatHashtable::print(ostream& out) const
+{
+  out << "[StatHashtable: " << size() << " keys";
+  if (isBounded()) {
+    out << " of " << m_max_entries << ", evictions " << m_evictions << ", max_error " << m_max_error;
+  }
+  out << "]";
+}
+
+// Output operator definition
+extern inline
+ostream& operator<<(ostream& out, const StatHashtable& obj)
+{
+  obj.print(out);
+  out << flush;
+  return out;
+}
+
+#endif //STATHASHTABLE_H
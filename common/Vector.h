@@ -76,6 +76,8 @@ public:
                          // be used when the TYPE is a pointer type.
   void removeFromTop(int num);  // removes elements from top 
   void print(ostream& out) const;
+  // bytes of the element array, including unused capacity
+  size_t getMemoryUsage() const { return size_t(m_max_size) * sizeof(TYPE); }
 
 
   // Array Reference operator overloading
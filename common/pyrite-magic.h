@@ -0,0 +1,30 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+#ifndef __PYRITE_MAGIC_H
+#define __PYRITE_MAGIC_H
+
+/* Requests understood by pyrite's magic instruction handler.  A guest
+   passes one in %eax with SIMULATOR_REQUEST (see x86-magic-request.h);
+   any other %eax value is left to other magic instruction handlers. */
+#define PYRITE_MAGIC_START_SAMPLING 0x50590001
+#define PYRITE_MAGIC_STOP_SAMPLING  0x50590002
+
+#endif
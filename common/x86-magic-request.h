@@ -21,6 +21,7 @@
 #define __X86_MAGIC_REQUEST_H
 
 #include <simics/magic-instruction.h> // for Simics' magic insn
+#include "pyrite-magic.h"
 
 
 /* Passes an argument to the simulator via %eax. */
@@ -74,4 +75,13 @@ extern inline void* SIMULATOR_REQUEST2(void* a, void* c) {
   return ret;
 }
 
+/* Start and stop pyrite's sampled simulation of the enclosed region. */
+extern inline void PYRITE_START_SAMPLING(void) {
+  SIMULATOR_REQUEST((void*) PYRITE_MAGIC_START_SAMPLING);
+}
+
+extern inline void PYRITE_STOP_SAMPLING(void) {
+  SIMULATOR_REQUEST((void*) PYRITE_MAGIC_STOP_SAMPLING);
+}
+
 #endif
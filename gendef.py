@@ -52,20 +52,15 @@ statTemplates = [ # STATISTICS
 
 %%STATS_CLASS%%::%%STATS_CLASS%%() { cout << "Constructing g_stats" << endl; }
   
-void %%STATS_CLASS%%::init(){ m_num_processors = g_params.getNumProcessors(); if (!g_params.getLoadingPyriteFromConfig()){ initStats(); }}
-
-#if 0
-// TODO: re-implement histograms
-%%histogram_global%%
-#endif
+void %%STATS_CLASS%%::init(){ m_num_processors = g_params.getNumProcessors(); m_histogram_digits = g_params.getHistogramSignificantDigits(); if (!g_params.getLoadingPyriteFromConfig()){ initStats(); }}
 
 // all stat functions live in the class definition in "%%FILE_ROOT%%.h"
 
-#if 0
-// TODO: re-implement histograms
-  %%create_histogram%%
-#endif
-  
+void %%STATS_CLASS%%::getIntervalFieldNames(Vector<string>& names) const {
+  names.clear();
+%%stat_interval_name%%
+}
+
 void %%STATS_CLASS%%::dumpStats(ostream& os) {
     os << "{" << endl; // start python dict
   
@@ -73,12 +68,10 @@ void %%STATS_CLASS%%::dumpStats(ostream& os) {
     %%stat_dump%%
     os << "'theVeryLastStat':None }," << endl;
 
-#if 0
-  // TODO: re-implement histograms someday
-  os << " 'histograms': {" << endl;
-  %%histogram_dump%%
-  os << "'theVeryLastHistogram':None }," << endl;
-#endif
+    os << " 'histograms': {" << endl;
+    %%histogram_dump%%
+    os << "'theVeryLastHistogram':None }," << endl;
+
     time_t curr = time(0);
     g_params.setExperimentFinishDate(curr);
   
@@ -115,6 +108,8 @@ attr_value_t %%STATS_CLASS%%::simwrap_dumpStats(void* arg, conf_object_t* obj,
 #include "Global.h"
 #include "Map.h"
 #include "Vector.h"
+#include "HdrHistogram.h"
+#include "StatHashtable.h"
 
 using namespace std;
 
@@ -124,6 +119,7 @@ class %%STATS_CLASS%% {
   private:
 %%stat_member%%
   int m_num_processors;
+  int m_histogram_digits;
 
   public:
   %%STATS_CLASS%%();
@@ -134,20 +130,23 @@ class %%STATS_CLASS%% {
 
 %%stat_method%%
 
+  // Interval sampling (see pyrite/IntervalStats.h): every STAT_INT,
+  // one field per processor for per-processor stats, in .def order
+  int getNumIntervalFields() const {
+    return 0
+%%stat_interval_count%%;
+  }
+  void getIntervalFieldNames(Vector<string>& names) const;
+  void snapshotIntervalFields(integer_t* out) const {
+%%stat_interval_snapshot%%
+  }
+
   void initStats() {
   %%stat_init%%
-#if 0
-// TODO: re-implement histograms
-%%histogram_init%%
-#endif
   }
 
   void clearStats() {
   %%stat_clear%%
-#if 0
-// TODO: re-implement histograms, and make code for clearing them
-// Insert code for clearing histograms here
-#endif
   }
 
 
@@ -155,33 +154,6 @@ class %%STATS_CLASS%% {
 
 extern %%STATS_CLASS%% %%STATS_GLOBAL%%;
 
-typedef struct bucket {
-  integer_t base;
-  uinteger_t count;
-  integer_t minSample;
-  integer_t maxSample;
-} bucket_t;
-
-typedef struct histogram {
-  bucket_t* bucketList;
-  char* name;
-  unsigned int allowOverflow : 1;
-  int numBuckets;
-  integer_t start;
-  int bucketRange;
-  uinteger_t totalSamples;
-} histogram_t;
-
-#if 0
-// TODO: re-implement histograms
-%%histogram_decl%%
-
-histogram_t* newHistogram(int buckets, integer_t start, int step, bool allowOverflow, const char* name);
-bool addHistogramSample(histogram_t* h, integer_t value);
-void printHistogram(FILE* f, histogram_t* h);
-void clearHistogram(histogram_t* h);
-#endif
-
 #endif
 """},
 
@@ -541,7 +513,7 @@ names are actual functions.
   attr_value_t val;
   if (idx->kind == Sim_Val_Integer){
     int index = idx->u.integer;
-    Vector<int> keys = %s.get%sKeys(index);
+    Vector<uint64> keys = %s.get%sKeys(index);
     val = SIM_alloc_attr_dict(keys.size());
     for (int j = 0; j < keys.size(); j++){
       attr_dict_pair_t pair;
@@ -555,7 +527,7 @@ names are actual functions.
     val = SIM_alloc_attr_list(%s);
     int i;
     for (i = 0; i < %s; i++){
-      Vector<int> keys = %s.get%sKeys(i);
+      Vector<uint64> keys = %s.get%sKeys(i);
       attr_value_t val_i = SIM_alloc_attr_dict(keys.size());
       for (int j = 0; j < keys.size(); j++){
         attr_dict_pair_t pair;
@@ -574,10 +546,10 @@ names are actual functions.
   attr_value_t val;
   if (idx->kind != Sim_Val_Nil){
     assert(idx->kind == Sim_Val_Integer);
-    int key = idx->u.integer;
+    uint64 key = idx->u.integer;
     val = SIM_make_attr_integer(%s.get%s(key));
   } else{
-    Vector<int> keys = %s.get%sKeys();
+    Vector<uint64> keys = %s.get%sKeys();
     val = SIM_alloc_attr_dict(keys.size());
     for (int i = 0; i < keys.size(); i++){
       attr_dict_pair_t pair;
@@ -627,8 +599,8 @@ names are actual functions.
       assert(key.kind == Sim_Val_Integer);
       attr_value_t value = curr.value;
       assert(value.kind == Sim_Val_Integer);
-      int key_value = key.u.integer;
-      int value_value = value.u.integer;
+      uint64 key_value = key.u.integer;
+      integer_t value_value = value.u.integer;
       %s.set%s(i, key_value, value_value);
     }
   }\n''' % (obj, name, obj, name)
@@ -649,8 +621,8 @@ names are actual functions.
       assert(key.kind == Sim_Val_Integer);
       attr_value_t value = curr.value;
       assert(value.kind == Sim_Val_Integer);
-      int key_value = key.u.integer;
-      int value_value = value.u.integer;
+      uint64 key_value = key.u.integer;
+      integer_t value_value = value.u.integer;
       %s.set%s(key_value, value_value);
     }
   }\n''' % (obj, name, obj, name, obj, name)
@@ -694,38 +666,98 @@ names are actual functions.
     return (getter + "\n" + setter, register)
 
 def generateHistogram( hist ):
-    """Adds a dictionary full of entries for the specified histogram
-to the global DEFS list"""
+    """Returns a dictionary full of entries for the specified histogram
+statistic, kept as a log-linear HdrHistogram (see ruby/common/HdrHistogram.h)"""
     t = { 'kind':str,
           'name':str,
-          'buckets':int,
-          'start':int,
-          'step':int,
-          Optional('allowOverflow'):bool }
+          Optional('significantDigits'):int,
+          Optional('per-processor'):bool }
     mustBeType( hist, Strict(t) )
-    
-    myDef = {}
 
-    globalVar = hist['name']
-    myDef['histogram_global'] = ["histogram_t* %s;" % globalVar]
+    myDef = {}
+    memberName = hist['name']
+    functionName = initialCaps( memberName )
 
-    myDef['histogram_decl'] = ["extern histogram_t* %s;" % globalVar]
+    perProcessorStat = ('per-processor' not in hist or hist['per-processor'])
+    if 'significantDigits' in hist:
+      digits = str(hist['significantDigits'])
+    else:
+      digits = "m_histogram_digits"
 
-    # create histogram, called as part of initStats()
-    oflow = "TRUE"
-    if 'allowOverflow' in hist and not hist['allowOverflow']:
-        oflow = "FALSE"
-    initCode = ('%s = newHistogram( %d/*buckets*/, %d/*start*/, %d/*step*/, %s/*allow oflow*/, "%s"/*name*/);'
-                % (globalVar, hist['buckets'], hist['start'], hist['step'], oflow, globalVar) )
-    myDef['create_histogram'] = [initCode]
+    # stat function definition
+    if perProcessorStat:
+      statGetter = "const HdrHistogram& get%s(int processor_number) { return *%s[processor_number]; }\n" % (functionName, memberName)
+    else:
+      statGetter = "const HdrHistogram& get%s(void) { return *%s; }\n" % (functionName, memberName)
+    myDef["stat_method"] = [statGetter]
+    # init
+    if perProcessorStat:
+      statInit = '''
+void init%s(int size){ 
+  %s = (HdrHistogram**) native_malloc(sizeof(HdrHistogram*) * size);
+  assert(%s != 0);
+  for(int i = 0; i < size; i++){
+    %s[i] = new HdrHistogram(%s);
+  }
+}\n''' % (functionName, memberName, memberName, memberName, digits)
+    else:
+      statInit = "void init%s(void) { %s = new HdrHistogram(%s); }\n" % (functionName, memberName, digits)
+    myDef["stat_method"].append(statInit)
+    if perProcessorStat:
+      myDef["stat_init"] = "init%s(m_num_processors);" % functionName
+    else:
+      myDef["stat_init"] = "init%s();" % functionName
+    # clear
+    if perProcessorStat:
+      statClear = '''
+void clear%s(void){ 
+  for(int i = 0; i < m_num_processors; i++){
+    %s[i]->clear();
+  }
+}\n''' % (functionName, memberName)
+    else:
+      statClear = "void clear%s(void) { %s->clear(); }\n" % (functionName, memberName)
+    myDef["stat_method"].append(statClear)
+    myDef["stat_clear"] = "clear%s();" % functionName
+    # sample
+    if perProcessorStat:
+      statSampler = "void sample%s(int processor_number, integer_t x) { %s[processor_number]->add(x); }\n" % (functionName, memberName)
+    else:
+      statSampler = "void sample%s(integer_t x) { %s->add(x); }\n" % (functionName, memberName)
+    myDef["stat_method"].append(statSampler)
+
+    # histogram dump - into a python dict entry holding the merged
+    # summary and, for per-processor stats, one summary per processor
+    summary = '''"{'count': " << %(h)s.size() << ", 'average': " << %(h)s.getAverage()
+         << ", 'min': " << %(h)s.getMin() << ", 'max': " << %(h)s.getMax()
+         << ", 'p50': " << %(h)s.getPercentile(50.0) << ", 'p90': " << %(h)s.getPercentile(90.0)
+         << ", 'p99': " << %(h)s.getPercentile(99.0) << ", 'p99.9': " << %(h)s.getPercentile(99.9) << "}"'''
+    if perProcessorStat:
+      myDef["histogram_dump"] = '''
+    {
+      HdrHistogram total(*%s[0]);
+      for (int i = 1; i < m_num_processors; i++){
+        total.merge(*%s[i]);
+      }
+      os << "'%s' : { 'all' : " << %s << ", 'per-processor' : [";
+      for (int i = 0; i < m_num_processors; i++){
+        os << %s << ",";
+      }
+      os << "]}," << endl;
+    }''' % (memberName, memberName, memberName,
+            summary % { 'h':'total' }, summary % { 'h':'(*%s[i])' % memberName })
+    else:
+      myDef["histogram_dump"] = '''
+    os << "'%s' : " << %s << "," << endl;''' % (memberName, summary % { 'h':'(*%s)' % memberName })
 
-    # clear histogram, called as part of clearStats()
-    myDef['histogram_init'] = ["clearHistogram( %s );" % globalVar]
+    # private instance variable of the Stats class
+    if perProcessorStat:
+      myDef["stat_member"] = "  HdrHistogram** %s;" % memberName
+    else:
+      myDef["stat_member"] = "  HdrHistogram* %s;" % memberName
 
-    # dump histogram as part of call to dumpStats()
-    printCode = "printHistogram( f, %s );" % globalVar
-    myDef['histogram_dump'] = [printCode]
-    
+    # histograms are not Simics attributes, so they are not restored
+    # from a checkpoint and start out empty
     return myDef
 
 def generateHashtableStat( stat ):
@@ -735,7 +767,8 @@ def generateHashtableStat( stat ):
           'name':str,
           'initialValue':int,
           Optional('per-processor'):bool,
-          Optional('printHexKey'):bool }
+          Optional('printHexKey'):bool,
+          Optional('capacity'):int }
     mustBeType( stat, Strict(t) )
     
     myDef = {}
@@ -749,6 +782,11 @@ def generateHashtableStat( stat ):
       printHexKey = stat['printHexKey']
     else:
       printHexKey = False
+    if 'capacity' in stat:
+      capacity = stat['capacity']
+      assert capacity > 0, "STAT_HASHTABLE " + stat['name'] + " must have a positive 'capacity'"
+    else:
+      capacity = 0
 
     preKey = ""
     postKey = ""
@@ -758,22 +796,22 @@ def generateHashtableStat( stat ):
     
     # stat function definition
     if perProcessorStat:
-      statGetter = "integer_t get%s(int processor_number, int key) { return %s[processor_number]->lookup(key); }" % (functionName, memberName)
+      statGetter = "integer_t get%s(int processor_number, uint64 key) { return %s[processor_number]->lookup(key, %d); }" % (functionName, memberName, statInitialValue)
     else:
-      statGetter = "integer_t get%s(int key) { return %s->lookup(key); }" % (functionName, memberName)
+      statGetter = "integer_t get%s(uint64 key) { return %s->lookup(key, %d); }" % (functionName, memberName, statInitialValue)
     myDef["stat_method"] = [statGetter]
     # init
     if perProcessorStat:
       statInit = '''
 void init%s(int size){ 
-  %s = (Map<int, int>**) native_malloc(sizeof(Map<int, int>*) * size);
+  %s = (StatHashtable**) native_malloc(sizeof(StatHashtable*) * size);
   assert(%s != 0);
   for(int i = 0;\ni < size; i++){
-    %s[i] = new Map<int, int>();
+    %s[i] = new StatHashtable(%d);
   }
-}\n''' % (functionName, memberName, memberName, memberName)
+}\n''' % (functionName, memberName, memberName, memberName, capacity)
     else:
-      statInit = "void init%s(void) { %s = new Map<int, int>; }\n" % (functionName, memberName)
+      statInit = "void init%s(void) { %s = new StatHashtable(%d); }\n" % (functionName, memberName, capacity)
     myDef["stat_method"].append(statInit)
     if perProcessorStat:
       myDef["stat_init"] = "init%s(m_num_processors);" % functionName
@@ -794,81 +832,81 @@ void clear%s(void){
     # setter
     if perProcessorStat:
         statSetter = '''
-void set%s(int processor_number, int key, integer_t x){ 
-  %s[processor_number]->add(key, x); 
+void set%s(int processor_number, uint64 key, integer_t x){ 
+  %s[processor_number]->set(key, x); 
 }\n''' % (functionName, memberName)
     else:
-        statSetter = "void set%s(int key, integer_t x){ %s->add(key, x); }\n" % (functionName, memberName)
+        statSetter = "void set%s(uint64 key, integer_t x){ %s->set(key, x); }\n" % (functionName, memberName)
     myDef["stat_method"].append( statSetter )
     # increment
     if perProcessorStat:
-      statIncrementer = "void increment%s(int processor_number, int key){ incrementN%s(processor_number, key, 1); }\n" % (functionName, functionName)
+      statIncrementer = "void increment%s(int processor_number, uint64 key){ incrementN%s(processor_number, key, 1); }\n" % (functionName, functionName)
     else:
-      statIncrementer = "void increment%s(int key){ incrementN%s(key, 1); }\n" % (functionName, functionName)
+      statIncrementer = "void increment%s(uint64 key){ incrementN%s(key, 1); }\n" % (functionName, functionName)
     myDef["stat_method"].append( statIncrementer )
-    # increment by n
+    # increment by n: a single find-or-insert probe
     if perProcessorStat:
       statNIncrementer = '''
-void incrementN%s(int processor_number, int key, int n){ 
-  int value = n;
-  if (!%s[processor_number]->exist(key)){ 
-    value += %d;
-  } else{
-    value += %s[processor_number]->lookup(key);
-  }
-  %s[processor_number]->add(key, value);
-}\n''' % (functionName, memberName, statInitialValue, memberName, memberName)
+void incrementN%s(int processor_number, uint64 key, integer_t n){ 
+  %s[processor_number]->incrementN(key, n, %d);
+}\n''' % (functionName, memberName, statInitialValue)
     else:
       statNIncrementer = '''
-void incrementN%s(int key, int n){
-  int value = n;
-  if (!%s->exist(key)){
-    value += %d;
-  } else{
-    value += %s->lookup(key);
-  }
-  %s->add(key, value);
-}\n''' % (functionName, memberName, statInitialValue, memberName, memberName)
+void incrementN%s(uint64 key, integer_t n){
+  %s->incrementN(key, n, %d);
+}\n''' % (functionName, memberName, statInitialValue)
     myDef["stat_method"].append( statNIncrementer )
     # decrementer
     if perProcessorStat:
-      statDecrementer = "void decrement%s(int processor_number, int key){ incrementN%s(processor_number, key, -1); }\n" % (functionName, functionName)
+      statDecrementer = "void decrement%s(int processor_number, uint64 key){ incrementN%s(processor_number, key, -1); }\n" % (functionName, functionName)
     else:
-      statDecrementer =  "void decrement%s(int key){ incrementN%s(key, -1); }\n" % (functionName, functionName)
+      statDecrementer =  "void decrement%s(uint64 key){ incrementN%s(key, -1); }\n" % (functionName, functionName)
     myDef["stat_method"].append( statDecrementer )
 
     if perProcessorStat:
-      statGetKeys = "Vector<int> get%sKeys(int processor_number){ return %s[processor_number]->keys();}\n" % (functionName, memberName)
+      statGetKeys = "Vector<uint64> get%sKeys(int processor_number){ return %s[processor_number]->keys();}\n" % (functionName, memberName)
     else:
-      statGetKeys = "Vector<int> get%sKeys(void){ return %s->keys();}\n" % (functionName, memberName)
+      statGetKeys = "Vector<uint64> get%sKeys(void){ return %s->keys();}\n" % (functionName, memberName)
     myDef["stat_method"].append(statGetKeys)
-    # stat dump function definition - into a python dict entry
+    # stat dump function definition - into a python dict entry.  A
+    # capped table also reports how many keys it dropped and the
+    # largest count it dropped.
     if perProcessorStat:
       myDef["stat_dump"] = '''    
     os << "'%s' : [";
     for (int i = 0; i < m_num_processors; i++){
       os << "{";
-      Vector<int> keys = %s[i]->keys();
+      Vector<uint64> keys = %s[i]->keys();
       for (int j = 0; j < keys.size(); j++){
         os << %s keys[j] << %s " : " << %s[i]->lookup(keys[j]) << "," << endl;
       }  
       os << "}," << endl;
     }
     os << "]," << endl;\n''' % (memberName, memberName, preKey, postKey, memberName)
+      if capacity > 0:
+        myDef["stat_dump"] += '''
+    os << "'%sEvicted' : [";
+    for (int i = 0; i < m_num_processors; i++){
+      os << "(" << %s[i]->getEvictions() << ", " << %s[i]->getMaxError() << "), ";
+    }
+    os << "]," << endl;\n''' % (memberName, memberName, memberName)
     else:
       myDef["stat_dump"] = '''
     os << "'%s' : {";
-    Vector<int> keys = %s->keys();
+    Vector<uint64> keys = %s->keys();
     for (int i = 0; i < keys.size(); i++){
       os << %s keys[i] << %s " : " << %s->lookup(keys[i]) << "," << endl;
     }  
     os << "}," << endl;''' % (memberName, memberName, preKey, postKey, memberName)
+      if capacity > 0:
+        myDef["stat_dump"] += '''
+    os << "'%sEvicted' : (" << %s->getEvictions() << ", " << %s->getMaxError() << ")," << endl;''' % (memberName, memberName, memberName)
 
     # private instance variable of the Stats class
     if perProcessorStat:
-      myDef["stat_member"] = "  Map<int, int>** %s;" % memberName
+      myDef["stat_member"] = "  StatHashtable** %s;" % memberName
     else:
-      myDef["stat_member"] = "  Map<int, int>* %s;" % memberName
+      myDef["stat_member"] = "  StatHashtable* %s;" % memberName
     
     if perProcessorStat:
       wrapper, registration = simicsAttributeWrapper( functionName, simicsType="list", obj=g_replacements['STATS_GLOBAL'], generateSetter=True, listLength="g_params.getNumProcessors()", listInternalType="dict" )
@@ -969,6 +1007,22 @@ void set%s(int processor_number, integer_t x) {
     else:
       myDef["stat_dump"] = 'os << "\'%s\': " << get%s() << "," << endl;\n' % (memberName, functionName)
 
+    # interval sampling: field count, names and a snapshot into a flat array
+    if perProcessorStat:
+      myDef["stat_interval_count"] = "      + m_num_processors"
+      myDef["stat_interval_name"] = '''  for (int i = 0; i < m_num_processors; i++){
+    ostringstream name;
+    name << "%s." << i;
+    names.insertAtBottom(name.str());
+  }''' % memberName
+      myDef["stat_interval_snapshot"] = '''    for (int i = 0; i < m_num_processors; i++){
+      *out++ = %s[i];
+    }''' % memberName
+    else:
+      myDef["stat_interval_count"] = "      + 1"
+      myDef["stat_interval_name"] = '  names.insertAtBottom("%s");' % memberName
+      myDef["stat_interval_snapshot"] = "    *out++ = %s;" % memberName
+
     # private instance variable of the Stats class
     if perProcessorStat:
       myDef["stat_member"] = "  integer_t* %s;" % memberName
@@ -1599,10 +1653,15 @@ def main():
                 stat = generateIntStat( d )
                 t = { 'stat_method':[OneOrMore(str)], 'stat_member':str,
                       'stat_dump':str, 'stat_init':str, 'stat_clear':str,
-                      'stat_wrapper':str, 'stat_attribute':str }
+                      'stat_wrapper':str, 'stat_attribute':str,
+                      'stat_interval_count':str, 'stat_interval_name':str,
+                      'stat_interval_snapshot':str }
                 mustBeType( stat, Strict(t) )
             elif d['kind'] == "STAT_HISTOGRAM":
                 stat = generateHistogram( d )
+                t = { 'stat_method':[OneOrMore(str)], 'stat_member':str,
+                      'histogram_dump':str, 'stat_init':str, 'stat_clear':str }
+                mustBeType( stat, Strict(t) )
             elif d['kind'] == "STAT_HASHTABLE":
                 stat = generateHashtableStat( d )
             DEFS.append( stat )
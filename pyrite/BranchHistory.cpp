@@ -0,0 +1,42 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+//===-- BranchHistory.cpp - long global histories for predictors -*- C++ -*--=//
+//
+//! Checkpointing of the global history.
+//
+//===----------------------------------------------------------------------===//
+
+#include "BranchHistory.h"
+#include "Checkpoint.h"
+
+void
+GlobalHistory::checkpoint(CheckpointWriter& cp, const State &state) const {
+  cp.write(m_num_folds);
+  cp.writeArray(&m_bits[0], m_bits.size());
+  cp.writeBytes(&state, sizeof(state));
+}
+
+void
+GlobalHistory::restore(CheckpointReader& cp) {
+  cp.check(m_num_folds, "history folds");
+  cp.readArray(&m_bits[0], m_bits.size());
+  memcpy(&m_state, cp.readBytes(sizeof(m_state)), sizeof(m_state));
+}
@@ -0,0 +1,123 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+//===-- BranchHistory.h - long global histories for predictors ---*- C++ -*--=//
+//
+//! The global history of the TAGE-style predictors: a circular bit
+//! buffer, long enough for the longest history plus everything pushed
+//! by the branches in flight, and the folded (compressed) copies of its
+//! prefixes that the predictor tables hash with.  A push only moves
+//! the head forward, so the bits behind the head are never lost and a
+//! squash is a single copy of a saved State.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef __BRANCH_HISTORY_H
+#define __BRANCH_HISTORY_H
+
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include "globals.h"
+
+class CheckpointWriter;
+class CheckpointReader;
+
+class GlobalHistory {
+public:
+  static const int MAX_FOLDS = 48;
+
+  //! everything a push changes
+  struct State {
+    W64 m_head;
+    W64 m_path;                 // one address bit per pushed branch
+    unsigned m_folds[MAX_FOLDS];
+  };
+
+  //! room for max_length bits of history plus max_inflight_bits pushed
+  //! by branches that may still be squashed
+  GlobalHistory(int max_length, int max_inflight_bits) : m_num_folds(0) {
+    unsigned size = 1;
+    while (size < (unsigned) (max_length + max_inflight_bits + 1)) {
+      size <<= 1;
+    }
+    m_bits.resize(size, 0);
+    m_mask = size - 1;
+    clear();
+  }
+
+  //! adds a folded copy of the newest length bits, compressed to
+  //! width bits; returns its index for getFold()
+  int addFold(int length, int width) {
+    assert(m_num_folds < MAX_FOLDS);
+    assert((width > 0) && (width < 32) && ((unsigned) length <= m_mask));
+    m_fold_length[m_num_folds] = length;
+    m_fold_width[m_num_folds] = width;
+    m_fold_outpoint[m_num_folds] = length % width;
+    m_state.m_folds[m_num_folds] = 0;
+    return m_num_folds ++;
+  }
+  unsigned getFold(int fold) const { return m_state.m_folds[fold]; }
+  W64 getPath() const { return m_state.m_path; }
+
+  void push(bool bit, Waddr rip) { push(m_state, bit, rip); }
+
+  //! pushes onto a saved state, e.g. to advance the committed history;
+  //! the bit written must be the one the speculative history pushed
+  //! there, if any
+  void push(State &state, bool bit, Waddr rip) {
+    ++ state.m_head;
+    m_bits[state.m_head & m_mask] = bit;
+    state.m_path = (state.m_path << 1) | ((rip >> 2) & 1);
+    for (int i = 0 ; i < m_num_folds ; i ++) {
+      // shift in the new bit and drop the one that just left the window
+      unsigned bit_out = m_bits[(state.m_head - m_fold_length[i]) & m_mask];
+      unsigned comp = (state.m_folds[i] << 1) | bit;
+      comp ^= bit_out << m_fold_outpoint[i];
+      comp ^= comp >> m_fold_width[i];
+      state.m_folds[i] = comp & ((1 << m_fold_width[i]) - 1);
+    }
+  }
+
+  const State &getState() const { return m_state; }
+  void setState(const State &state) { m_state = state; }
+
+  void clear() {
+    memset(&m_state, 0, sizeof(m_state));
+    std::fill(m_bits.begin(), m_bits.end(), 0);
+  }
+
+  //! save the bits with the given state (normally the committed one)
+  //! and restore them as the current state; the folds must have been
+  //! added the same way
+  void checkpoint(CheckpointWriter& cp, const State &state) const;
+  void restore(CheckpointReader& cp);
+
+private:
+  std::vector<unsigned char> m_bits;
+  W64 m_mask;
+  State m_state;
+  int m_num_folds;
+  int m_fold_length[MAX_FOLDS];
+  int m_fold_width[MAX_FOLDS];
+  int m_fold_outpoint[MAX_FOLDS];
+};
+
+#endif /* __BRANCH_HISTORY_H */
@@ -0,0 +1,102 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+//===-- BranchTargetBuffer.cpp - set-associative BTB -------------*- C++ -*--=//
+//
+//! The branch target buffer; see BranchTargetBuffer.h.
+//
+//===----------------------------------------------------------------------===//
+
+#include "BranchTargetBuffer.h"
+#include "Checkpoint.h"
+
+BranchTargetBuffer::BranchTargetBuffer(int entries, int assoc)
+  : m_assoc(assoc), m_tags(entries, 0), m_last_use(entries, 0), 
+    m_stamp(0), m_lookups(0), m_misses(0) {
+  if ((assoc <= 0) || (entries % assoc != 0)) {
+    ERROR_MSG("btbEntries must be a multiple of btbAssoc");
+  }
+  m_num_sets = entries / assoc;
+  if ((m_num_sets & (m_num_sets - 1)) != 0) {
+    ERROR_MSG("btbEntries / btbAssoc must be a power of two");
+  }
+  m_set_bits = 0;
+  while ((1 << m_set_bits) < m_num_sets) {
+    ++ m_set_bits;
+  }
+}
+
+int
+BranchTargetBuffer::find(Waddr rip) const {
+  int base = setIndex(rip) * m_assoc;
+  for (int way = 0 ; way < m_assoc ; way ++) {
+    if ((m_last_use[base + way] != 0) && (m_tags[base + way] == rip)) {
+      return base + way;
+    }
+  }
+  return -1;
+}
+
+bool
+BranchTargetBuffer::lookup(Waddr rip) {
+  ++ m_lookups;
+  int entry = find(rip);
+  if (entry < 0) {
+    ++ m_misses;
+    return false;
+  }
+  m_last_use[entry] = ++ m_stamp;
+  return true;
+}
+
+void
+BranchTargetBuffer::insert(Waddr rip) {
+  int entry = find(rip);
+  if (entry < 0) {
+    // an invalid entry has the oldest stamp of all
+    int base = setIndex(rip) * m_assoc;
+    entry = base;
+    for (int way = 1 ; way < m_assoc ; way ++) {
+      if (m_last_use[base + way] < m_last_use[entry]) {
+        entry = base + way;
+      }
+    }
+    m_tags[entry] = rip;
+  }
+  m_last_use[entry] = ++ m_stamp;
+}
+
+void
+BranchTargetBuffer::checkpoint(CheckpointWriter& cp) const {
+  cp.write(m_assoc);
+  cp.writeArray(&m_tags[0], m_tags.size());
+  cp.writeArray(&m_last_use[0], m_last_use.size());
+  cp.write(uint64(m_stamp));
+}
+
+void
+BranchTargetBuffer::restore(CheckpointReader& cp) {
+  uint64 stamp;
+  cp.check(m_assoc, "BTB associativity");
+  cp.readArray(&m_tags[0], m_tags.size());
+  cp.readArray(&m_last_use[0], m_last_use.size());
+  cp.read(stamp);
+  m_stamp = stamp;
+}
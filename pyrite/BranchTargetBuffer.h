@@ -0,0 +1,69 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+//===-- BranchTargetBuffer.h - set-associative BTB ---------------*- C++ -*--=//
+//
+//! The branch target buffer tells fetch, before decode, that there is
+//! a branch at an address.  Only presence is modeled: the direction,
+//! indirect and return predictors supply the targets.  A branch that
+//! is predicted taken but misses in the BTB is only redirected by
+//! decode, which costs fetch bubbles (see Processor::fetch()).  Taken
+//! branches are inserted when they resolve, with LRU replacement.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef __BRANCH_TARGET_BUFFER_H
+#define __BRANCH_TARGET_BUFFER_H
+
+#include <vector>
+#include "globals.h"
+
+class CheckpointWriter;
+class CheckpointReader;
+
+class BranchTargetBuffer {
+public:
+  BranchTargetBuffer(int entries, int assoc);
+
+  //! is the branch at rip in the BTB; counted in the stats
+  bool lookup(Waddr rip);
+  void insert(Waddr rip);
+
+  W64 getLookups() const { return m_lookups; }
+  W64 getMisses() const { return m_misses; }
+  void clearStats() { m_lookups = m_misses = 0; }
+
+  void checkpoint(CheckpointWriter& cp) const;
+  void restore(CheckpointReader& cp);
+
+private:
+  int find(Waddr rip) const;
+  unsigned setIndex(Waddr rip) const {
+    return (unsigned) (rip ^ (rip >> m_set_bits)) & (m_num_sets - 1);
+  }
+
+  int m_num_sets, m_set_bits, m_assoc;
+  std::vector<Waddr> m_tags;
+  std::vector<W64> m_last_use;  // 0 for an invalid entry
+  W64 m_stamp;
+  W64 m_lookups, m_misses;
+};
+
+#endif /* __BRANCH_TARGET_BUFFER_H */
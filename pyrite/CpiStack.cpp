@@ -0,0 +1,107 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+//===-- CpiStack.cpp - cycle accounting by stall cause -----------*- C++ -*--=//
+//
+//! Maps the CPI stack components onto their stats.
+//
+//===----------------------------------------------------------------------===//
+
+#include <iomanip>
+#include "CpiStack.h"
+#include "stats.h"
+
+typedef void (Stats::*CpiIncrement)(int, integer_t);
+typedef integer_t (Stats::*CpiGetter)(int);
+
+static const struct {
+  const char *m_name;
+  CpiIncrement m_increment;
+  CpiGetter m_get;
+} CPI_COMPONENTS[NUM_CPI_COMPONENTS] = {
+  {"base", &Stats::incrementNCpiBase, &Stats::getCpiBase},
+  {"frontend_bubble", &Stats::incrementNCpiFrontendBubble, &Stats::getCpiFrontendBubble},
+  {"frontend_refetch", &Stats::incrementNCpiFrontendRefetch, &Stats::getCpiFrontendRefetch},
+  {"frontend_mispredict", &Stats::incrementNCpiFrontendMispredict, &Stats::getCpiFrontendMispredict},
+  {"rob_full", &Stats::incrementNCpiRobFull, &Stats::getCpiRobFull},
+  {"lsq_full", &Stats::incrementNCpiLsqFull, &Stats::getCpiLsqFull},
+  {"scheduler_full", &Stats::incrementNCpiSchedulerFull, &Stats::getCpiSchedulerFull},
+  {"execute", &Stats::incrementNCpiExecute, &Stats::getCpiExecute},
+  {"store_forward", &Stats::incrementNCpiStoreForward, &Stats::getCpiStoreForward},
+  {"replay", &Stats::incrementNCpiReplay, &Stats::getCpiReplay},
+  {"memory_l1", &Stats::incrementNCpiMemoryL1, &Stats::getCpiMemoryL1},
+  {"memory_l2", &Stats::incrementNCpiMemoryL2, &Stats::getCpiMemoryL2},
+  {"memory_directory", &Stats::incrementNCpiMemoryDirectory, &Stats::getCpiMemoryDirectory},
+  {"memory_dram", &Stats::incrementNCpiMemoryDram, &Stats::getCpiMemoryDram}
+};
+
+const char *
+CpiStack::getName(CpiComponent component) {
+  assert(component < NUM_CPI_COMPONENTS);
+  return CPI_COMPONENTS[component].m_name;
+}
+
+CpiComponent
+CpiStack::fromMemorySource(MemorySource source) {
+  switch (source) {
+    case SOURCE_L2:
+      return CPI_MEMORY_L2;
+    case SOURCE_DIRECTORY:
+      return CPI_MEMORY_DIRECTORY;
+    case SOURCE_DRAM:
+      return CPI_MEMORY_DRAM;
+    default:
+      return CPI_MEMORY_L1;
+  }
+}
+
+void
+CpiStack::charge(int processor_number, CpiComponent component, integer_t cycles) {
+  assert(component < NUM_CPI_COMPONENTS);
+  (g_stats.*CPI_COMPONENTS[component].m_increment)(processor_number, cycles);
+}
+
+integer_t
+CpiStack::getCycles(int processor_number, CpiComponent component) {
+  assert(component < NUM_CPI_COMPONENTS);
+  return (g_stats.*CPI_COMPONENTS[component].m_get)(processor_number);
+}
+
+void
+CpiStack::print(std::ostream &out, int processor_number) {
+  integer_t total = 0;
+  for (int i = 0; i < NUM_CPI_COMPONENTS; i++) {
+    total += getCycles(processor_number, (CpiComponent)i);
+  }
+  integer_t instructions = g_stats.getCorrectlyExecutedX86Instructions(processor_number);
+
+  out << "CPI stack for processor " << processor_number << ": " << total << " cycles, "
+      << instructions << " x86 instructions" << std::endl;
+  for (int i = 0; i < NUM_CPI_COMPONENTS; i++) {
+    integer_t cycles = getCycles(processor_number, (CpiComponent)i);
+    out << "  " << std::setw(20) << std::left << getName((CpiComponent)i) << std::right
+        << std::setw(14) << cycles
+        << std::setw(9) << std::fixed << std::setprecision(2)
+        << ((total > 0) ? (100.0 * cycles / total) : 0.0) << "%"
+        << std::setw(10) << std::setprecision(4)
+        << ((instructions > 0) ? ((double)cycles / instructions) : 0.0) << std::endl;
+  }
+  out.unsetf(std::ios::floatfield);
+}
@@ -0,0 +1,79 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+//===-- CpiStack.h - cycle accounting by stall cause -------------*- C++ -*--=//
+//
+//! The CPI stack charges every cycle of a processor to one component.
+//! A cycle that retires a uop is a base cycle; otherwise the oldest uop
+//! in flight says why nothing retired:
+//!   frontend  - it has not been dispatched yet: a plain fetch bubble,
+//!               or the refill after a refetch or a branch mispredict
+//!   backend   - it is dispatched but stuck: ROB full, waiting for the
+//!               memory system to take it (LSQ), waiting to be selected
+//!               (scheduler), or just executing
+//!   memory    - it is a load in the L1 pipeline, or a miss, charged to
+//!               the level MemoryInterface says filled it
+//!   store forwarding - a load waiting for an older store's data
+//!   replay    - it is being replayed after an ordering or consistency
+//!               violation, or after failing validation
+//! The components are per-processor STAT_INTs, so they also show up in
+//! the interval stats.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef __CPI_STACK_H
+#define __CPI_STACK_H
+
+#include <iostream>
+#include "Global.h"
+#include "MemoryInterface.h"
+
+enum CpiComponent {
+  CPI_BASE,
+  CPI_FRONTEND_BUBBLE,
+  CPI_FRONTEND_REFETCH,
+  CPI_FRONTEND_MISPREDICT,
+  CPI_ROB_FULL,
+  CPI_LSQ_FULL,
+  CPI_SCHEDULER_FULL,
+  CPI_EXECUTE,
+  CPI_STORE_FORWARD,
+  CPI_REPLAY,
+  CPI_MEMORY_L1,
+  CPI_MEMORY_L2,
+  CPI_MEMORY_DIRECTORY,
+  CPI_MEMORY_DRAM,
+  NUM_CPI_COMPONENTS
+};
+
+class CpiStack {
+public:
+  static const char *getName(CpiComponent component);
+  static CpiComponent fromMemorySource(MemorySource source);
+
+  static void charge(int processor_number, CpiComponent component, integer_t cycles = 1);
+  static integer_t getCycles(int processor_number, CpiComponent component);
+
+  //! one line per component: cycles, share of all cycles and the CPI it
+  //! adds per committed x86 instruction
+  static void print(std::ostream &out, int processor_number);
+};
+
+#endif /* __CPI_STACK_H */
@@ -34,16 +34,29 @@
 #include "DynamicInst.h"
 #include "Processor.h"
 #include "RubyMemoryInterface.h"
+#include "CpiStack.h"
 #include "params.h"
 
+void
+DynamicInst::attach(DynamicInstMemory *mem, DynamicInstCold *cold) {
+  m_mem = mem;
+  m_cold = cold;
+  m_recorded = false;
+  m_cold->m_record = 0;
+  reset();
+}
+
 void
 DynamicInst::init(Processor *processor, const TransOp &trans_op, Waddr rip,
                   uopimpl_func_t exec, QPointer q_ptr, W8 latency) {
   reset();
   m_processor = processor;
-  m_trans_op = trans_op;
+  m_opcode = trans_op.opcode;
+  m_rd = trans_op.rd;
+  m_user_flags = trans_op.nouserflags ? 0 : setflags_to_x86_flags[trans_op.setflags];
   m_rip = rip;
-  m_exec = exec;
+  m_cold->m_trans_op = trans_op;
+  m_cold->m_exec = exec;
   m_q_ptr = q_ptr;
   m_latency = latency;
 }
@@ -59,32 +72,49 @@ DynamicInst::reset() {
   m_check_exception = false;
   m_starts_x86_op = false;
   m_ends_x86_op = false;
-
+  m_store_blocked = false;
+  m_waiting_preg = REG_NULL_SRC;
+  m_opcode = OP_nop;
+  m_rd = REG_zero;
+  m_user_flags = 0;
   m_rip = 0;
-  m_pred_target = 0;
 
-  
   m_q_ptr = 0;
   m_ra_preg = m_rb_preg = m_rc_preg = REG_NULL_SRC;
   m_rd_preg = m_rd_preg_old = m_rof_preg_old = m_rcf_preg_old = m_rzapsf_preg_old = REG_NULL_DEST; 
-  m_mem_operand.clear();
   m_stage = FETCH_STAGE;
-  assert(m_store_waiters.empty());
+
+  m_mem->m_mem_operand.clear();
+  m_mem->m_execute_cycle = 0;
+  m_mem->m_miss_cycle = 0;
+  m_mem->m_miss_stall_cycles = 0;
+  assert(m_mem->m_store_waiters.empty());
+
+  m_cold->m_pred_target = 0;
+  memset(m_cold->m_stage_cycle, 0, sizeof(m_cold->m_stage_cycle));
+  m_cold->m_seq_num = 0;
+  m_cold->m_uop_num = 0;
 }
 
+//! copies the state, not the slot: the memory and cold records stay
+//! the ones of this window slot
 DynamicInst &
 DynamicInst::operator= (const DynamicInst &rhs) {
   if (this != &rhs) {
     assert(rhs.detached());
-    assert(rhs.m_store_waiters.empty());
-    m_trans_op = rhs.m_trans_op;
+    assert(rhs.m_mem->m_store_waiters.empty());
     m_executed = rhs.m_executed;
     m_lsq_inserted = rhs.m_lsq_inserted;
     m_unaligned = rhs.m_unaligned;
     m_latency = rhs.m_latency;
+    m_opcode = rhs.m_opcode;
+    m_rd = rhs.m_rd;
+    m_user_flags = rhs.m_user_flags;
+    m_rip = rhs.m_rip;
 
     m_mispredicted = rhs.m_mispredicted;
-    m_pred_target = rhs.m_pred_target;
+    m_store_blocked = rhs.m_store_blocked;
+    m_waiting_preg = rhs.m_waiting_preg;
   
     m_q_ptr = rhs.m_q_ptr;
     m_ra_preg = rhs.m_ra_preg;
@@ -95,14 +125,26 @@ DynamicInst::operator= (const DynamicInst &rhs) {
     m_rof_preg_old = rhs.m_rof_preg_old;
     m_rcf_preg_old = rhs.m_rcf_preg_old;
     m_rzapsf_preg_old = rhs.m_rzapsf_preg_old;
-    m_mem_operand = rhs.m_mem_operand;
-    m_exec = rhs.m_exec;
-    m_is = rhs.m_is;
-    m_rb = rhs.m_rb;
     m_stage = rhs.m_stage;
-    m_record = 0;
-    assert(m_store_waiters.empty());
+
+    assert(m_mem->m_store_waiters.empty());
+    m_mem->m_mem_operand = rhs.m_mem->m_mem_operand;
+    m_mem->m_execute_cycle = rhs.m_mem->m_execute_cycle;
+    m_mem->m_miss_cycle = rhs.m_mem->m_miss_cycle;
+    m_mem->m_miss_stall_cycles = rhs.m_mem->m_miss_stall_cycles;
+    m_mem->m_rb = rhs.m_mem->m_rb;
+
+    m_cold->m_trans_op = rhs.m_cold->m_trans_op;
+    m_cold->m_pred_target = rhs.m_cold->m_pred_target;
+    m_cold->m_exec = rhs.m_cold->m_exec;
+    m_cold->m_is = rhs.m_cold->m_is;
+    memcpy(m_cold->m_stage_cycle, rhs.m_cold->m_stage_cycle, sizeof(m_cold->m_stage_cycle));
+    m_cold->m_seq_num = rhs.m_cold->m_seq_num;
+    m_cold->m_uop_num = rhs.m_cold->m_uop_num;
+    m_cold->m_record = 0;
+    m_recorded = false;
   }
+  return *this;
 }
 
 inst_record_t::stage_t STAGE_MAP[MAX_STAGES] = {
@@ -119,8 +161,14 @@ inst_record_t::stage_t STAGE_MAP[MAX_STAGES] = {
 
 void 
 DynamicInst::setStage(enum StageType _stage) { 
-  if (m_record) {
-    m_record->Set(STAGE_MAP[_stage], m_processor->getCurrentCycle());
+  if (m_recorded) {
+    m_cold->m_record->Set(STAGE_MAP[_stage], m_processor->getCurrentCycle());
+  }
+  if (m_processor->getPipeTrace().isOpen()) {
+    if (_stage == FETCH_STAGE) {  // (re)fetched, forget any earlier trip
+      memset(m_cold->m_stage_cycle, 0, sizeof(m_cold->m_stage_cycle));
+    }
+    m_cold->m_stage_cycle[_stage] = m_processor->getCurrentCycle();
   }
   m_stage = _stage; 
 }
@@ -128,8 +176,8 @@ DynamicInst::setStage(enum StageType _stage) {
 bool 
 DynamicInst::uopIsLegal(){
   // check for insns using CTX reg in anything other than ra
-  if ((m_trans_op.rb == REG_ctx) || (m_trans_op.rc == REG_ctx) ||
-      (m_trans_op.rd == REG_ctx)){
+  if ((m_cold->m_trans_op.rb == REG_ctx) || (m_cold->m_trans_op.rc == REG_ctx) ||
+      (m_cold->m_trans_op.rd == REG_ctx)){
     g_stats.incrementInstructionsUsingCTXReg(m_processor->getProcNum());
     return false;
   }
@@ -138,14 +186,24 @@ DynamicInst::uopIsLegal(){
 
 void
 DynamicInst::squash() {
-  assert(m_store_waiters.empty());
+  assert(m_mem->m_store_waiters.empty());
 
   if (waiting()) { detach(); }
-  if (m_record) {
-    m_record->Free();
-    m_record = NULL;
+  if (m_waiting_preg != REG_NULL_SRC) {
+    m_processor->getPhysicalFile().removeConsumer(m_waiting_preg, m_processor->getWindowSlot(m_q_ptr));
+    m_waiting_preg = REG_NULL_SRC;
+  }
+  if (m_recorded) {
+    m_cold->m_record->Free();
+    m_cold->m_record = NULL;
+    m_recorded = false;
+  }
+  if (m_processor->getPipeTrace().isOpen()) {
+    m_processor->getPipeTrace().record(*this, 0,
+                                       g_stats.getCorrectlyExecutedX86Instructions(m_processor->getProcNum()));
   }
   unwindRegisters();
+  chargeMissStalls();
 
   m_executed = false;
   m_lsq_inserted = false;
@@ -154,8 +212,9 @@ DynamicInst::squash() {
   m_load_ordering_violation = false;
   m_load_consistency_violation = false;
   m_check_exception = false;
+  m_store_blocked = false;
 
-  m_mem_operand.clear();
+  m_mem->m_mem_operand.clear();
 }
 
 void
@@ -180,8 +239,8 @@ DynamicInst::unwindRegisters() {
       m_rc_preg = REG_NULL_SRC;
     }
     if(m_rd_preg != REG_NULL_DEST) {
-      if (m_trans_op.setflags && !m_trans_op.nouserflags) {
-        W64 flagmask = setflags_to_x86_flags[m_trans_op.setflags];
+      if (m_cold->m_trans_op.setflags && !m_cold->m_trans_op.nouserflags) {
+        W64 flagmask = setflags_to_x86_flags[m_cold->m_trans_op.setflags];
         if(flagmask & FLAG_OF) {
           front_end_map.setMapping(REG_of, m_rof_preg_old);
           physical_file.decrementRefCount(m_rof_preg_old);
@@ -196,7 +255,7 @@ DynamicInst::unwindRegisters() {
         }
       }
 
-      front_end_map.setMapping(m_trans_op.rd, m_rd_preg_old);
+      front_end_map.setMapping(m_cold->m_trans_op.rd, m_rd_preg_old);
       physical_file.decrementRefCount(m_rd_preg_old);
       m_rd_preg = m_rd_preg_old = m_rof_preg_old = m_rcf_preg_old = m_rzapsf_preg_old = REG_NULL_DEST; 
     }
@@ -222,40 +281,39 @@ DynamicInst::rename() {
   PhysicalFile &physical_file = m_processor->getPhysicalFile();
 	 
   // rename source registers
-  m_ra_preg = front_end_map.getMapping(m_trans_op.ra);
+  m_ra_preg = front_end_map.getMapping(m_cold->m_trans_op.ra);
   physical_file.incrementRefCount(m_ra_preg);
 
-//  printf("ra mapping: %d->%d\n", m_trans_op.ra, m_ra_preg);
+//  printf("ra mapping: %d->%d\n", m_cold->m_trans_op.ra, m_ra_preg);
 
-  if(m_trans_op.rb != REG_imm) {
-    m_rb_preg = front_end_map.getMapping(m_trans_op.rb);
+  if(m_cold->m_trans_op.rb != REG_imm) {
+    m_rb_preg = front_end_map.getMapping(m_cold->m_trans_op.rb);
     physical_file.incrementRefCount(m_rb_preg);
-//     printf("rb mapping: %d->%d\n", m_trans_op.rb, m_rb_preg);
+//     printf("rb mapping: %d->%d\n", m_cold->m_trans_op.rb, m_rb_preg);
   }
   
-  if (m_trans_op.rc != REG_imm) {
-    m_rc_preg = front_end_map.getMapping(m_trans_op.rc);
+  if (m_cold->m_trans_op.rc != REG_imm) {
+    m_rc_preg = front_end_map.getMapping(m_cold->m_trans_op.rc);
     physical_file.incrementRefCount(m_rc_preg);
-//	 printf("rc mapping: %d->%d\n", m_trans_op.rc, m_rc_preg);
+//	 printf("rc mapping: %d->%d\n", m_cold->m_trans_op.rc, m_rc_preg);
   }
   
-  assert(!uopWritesDestinationRegister(m_trans_op) ||
-         (uopWritesDestinationRegister(m_trans_op) &&
-          (!isbranch(m_trans_op.opcode) ||
-           !(m_trans_op.setflags && !m_trans_op.nouserflags))));
+  assert(!uopWritesDestinationRegister(m_cold->m_trans_op) ||
+         (uopWritesDestinationRegister(m_cold->m_trans_op) &&
+          (!isbranch(m_opcode) ||
+           !(m_cold->m_trans_op.setflags && !m_cold->m_trans_op.nouserflags))));
 
   // allocate a new physical registers, capture the old mapping and update rename map
-  if (uopWritesDestinationRegister(m_trans_op) && !isbranch(m_trans_op.opcode) &&
-      (m_trans_op.rd != REG_zero)) {
-    m_rd_preg_old = front_end_map.getMapping(m_trans_op.rd);
+  if (allocatesRegister()) {
+    m_rd_preg_old = front_end_map.getMapping(m_cold->m_trans_op.rd);
     physical_file.incrementRefCount(m_rd_preg_old);
     assert(m_rd_preg_old > REG_NULL_SRC);
-    m_rd_preg = front_end_map.getNewMapping(m_trans_op.rd);
-//	 printf("rd mapping: %d->%d (old = %d)\n", m_trans_op.rd, m_rd_preg, m_rd_preg_old);
+    m_rd_preg = front_end_map.getNewMapping(m_cold->m_trans_op.rd);
+//	 printf("rd mapping: %d->%d (old = %d)\n", m_cold->m_trans_op.rd, m_rd_preg, m_rd_preg_old);
 
-    if (m_trans_op.setflags && !m_trans_op.nouserflags) {
-      assert(!isbranch(m_trans_op.opcode));
-      W64 flagmask = setflags_to_x86_flags[m_trans_op.setflags];
+    if (m_cold->m_trans_op.setflags && !m_cold->m_trans_op.nouserflags) {
+      assert(!isbranch(m_opcode));
+      W64 flagmask = setflags_to_x86_flags[m_cold->m_trans_op.setflags];
       if(flagmask & FLAG_OF) {
         m_rof_preg_old = front_end_map.getMapping(REG_of);
         physical_file.incrementRefCount(m_rof_preg_old);
@@ -278,15 +336,15 @@ DynamicInst::rename() {
   }
 
   /* for tracking register dependences when recording instruction execution */
-  if (m_record) {
+  if (m_recorded) {
     if (m_ra_preg != REG_NULL_SRC) { 
-      m_record->SetRegProducer(physical_file.getWriter(m_ra_preg));
+      m_cold->m_record->SetRegProducer(physical_file.getWriter(m_ra_preg));
     }
     if (m_rb_preg != REG_NULL_SRC) { 
-      m_record->SetRegProducer(physical_file.getWriter(m_rb_preg));
+      m_cold->m_record->SetRegProducer(physical_file.getWriter(m_rb_preg));
     }
     if (m_rc_preg != REG_NULL_SRC) { 
-      m_record->SetRegProducer(physical_file.getWriter(m_rc_preg));
+      m_cold->m_record->SetRegProducer(physical_file.getWriter(m_rc_preg));
     }
 
     if (m_rd_preg != REG_NULL_DEST) { 
@@ -297,37 +355,50 @@ DynamicInst::rename() {
 
 void 
 DynamicInst::queue() { 
-  LOG_EVENT(DEBUG_UOP, Box<TransOp>(m_trans_op), "Current uop.");
+  LOG_EVENT(DEBUG_UOP, Box<TransOp>(m_cold->m_trans_op), "Current uop.");
 
-  if (m_record) { 
-    m_record->Set(inst_record_t::QUEUE_STAGE, m_processor->getCurrentCycle());
+  if (m_recorded) { 
+    m_cold->m_record->Set(inst_record_t::QUEUE_STAGE, m_processor->getCurrentCycle());
   }
   setStage(WAIT_RA_STAGE);
 }
 
+bool
+DynamicInst::allocatesRegister() {
+  return (uopWritesDestinationRegister(m_cold->m_trans_op) && !isbranch(m_opcode) &&
+          (m_cold->m_trans_op.rd != REG_zero));
+}
+
+void
+DynamicInst::waitForRegister(PhysName preg) {
+  m_waiting_preg = preg;
+  m_processor->getPhysicalFile().addConsumer(preg, m_processor->getWindowSlot(m_q_ptr));
+}
+
 void
 DynamicInst::schedule() { 
   /* after decoding the instruction we put it in the window. Check
      whether the instruction is ready to be m_executed.  If register
-     value is not ready, put the instruction in a waiting list for
-     that register, otherwise send the instruction to the scheduler */
+     value is not ready, make the instruction a consumer of that
+     register, otherwise send the instruction to the scheduler */
   PhysicalFile &pfile = m_processor->getPhysicalFile();
+  m_waiting_preg = REG_NULL_SRC;  // any register it waited on woke it up
 
   switch (m_stage) {
     case WAIT_RA_STAGE:
       if ((m_ra_preg != REG_NULL_SRC) && !pfile.isReady(m_ra_preg)) {
-        pfile.addWaiter(m_ra_preg, this);
+        waitForRegister(m_ra_preg);
         break;
       }
       setStage(WAIT_RB_STAGE);
       /* fall through */
     case WAIT_RB_STAGE:
       if ((m_rb_preg != REG_NULL_SRC) && !pfile.isReady(m_rb_preg)) {
-        pfile.addWaiter(m_rb_preg, this);
+        waitForRegister(m_rb_preg);
         break;
       }
 
-      if (isload(m_trans_op.opcode) || isstore(m_trans_op.opcode)) { 
+      if (isload(m_opcode) || isstore(m_opcode)) { 
         if (!addressGenerate()) {
           break;
         }
@@ -338,7 +409,7 @@ DynamicInst::schedule() {
       /* fall through */
     case WAIT_RC_STAGE:
       if ((m_rc_preg != REG_NULL_SRC) && !pfile.isReady(m_rc_preg)) {
-        pfile.addWaiter(m_rc_preg, this);
+        waitForRegister(m_rc_preg);
         break;
       }
       setStage(READY_STAGE);
@@ -363,6 +434,7 @@ DynamicInst::schedule() {
 void 
 DynamicInst::beginExecution() { 
   setStage(EXECUTE_STAGE); 
+  m_mem->m_execute_cycle = m_processor->getCurrentCycle();
 }
 
 bool
@@ -376,86 +448,88 @@ DynamicInst::execute() {
   // read registers
   W64 ra, rc;  // rb is allocated into "this" to survive to do "Complete()" if deferred by a cache miss
   W16 raflags, rbflags, rcflags;
-  readRegisters(ra, m_rb, rc, raflags, rbflags, rcflags);
+  readRegisters(ra, m_mem->m_rb, rc, raflags, rbflags, rcflags);
 	 
   // execute
-  m_processor->logUopExecution(m_trans_op, ra, m_rb, rc, raflags, rbflags, rcflags);
+  m_processor->logUopExecution(m_cold->m_trans_op, ra, m_mem->m_rb, rc, raflags, rbflags, rcflags);
 	 
-  bzero( &m_is, sizeof(IssueState) );
-  m_is.reg.rdflags = 0;
-  m_is.reg.rddata = 0;
+  bzero( &m_cold->m_is, sizeof(IssueState) );
+  m_cold->m_is.reg.rdflags = 0;
+  m_cold->m_is.reg.rddata = 0;
 	 
-  if (isfence(m_trans_op.opcode)) {
+  if (isfence(m_opcode)) {
     // treated as a no-op for now
-  } else if (isload(m_trans_op.opcode)) { // load
+  } else if (isload(m_opcode)) { // load
     if (m_unaligned) { 
       m_processor->alignmentException(m_q_ptr);
       return true;
     }
 
-    if (m_mem_operand.getSize() == 0) {
-      assert(m_trans_op.cond == LDST_ALIGN_HI);
+    if (m_mem->m_mem_operand.getSize() == 0) {
+      assert(m_cold->m_trans_op.cond == LDST_ALIGN_HI);
       complete();
       return true;
     }
     
     LoadStoreQueue &lsq = m_processor->getLSQ();
-    DoubleWord lsq_data(m_mem_operand);
-    bool needs_to_wait = !lsq.loadSearch(this, &m_mem_operand, &lsq_data);
+    DoubleWord lsq_data(m_mem->m_mem_operand);
+    bool needs_to_wait = !lsq.loadSearch(this, &m_mem->m_mem_operand, &lsq_data);
+    m_store_blocked = needs_to_wait;
 
     if (needs_to_wait) {
       return true;  // can't complete now, loadSearch put us on a store's waitlist
     }
 
-    if (!lsq_data.covers(m_mem_operand) && !m_trans_op.internal) {
+    if (!lsq_data.covers(m_mem->m_mem_operand) && !m_cold->m_trans_op.internal) {
         
-      m_processor->cacheAccess(this, REQUEST_READ, m_mem_operand.alignedAddr());
+      m_processor->cacheAccess(this, REQUEST_READ, m_mem->m_mem_operand.alignedAddr());
       setStage(MEMORY_STAGE);
         
       if (!detached()) { // must have missed
         recordEvent(inst_record_t::DCACHE_MISS);
+        m_mem->m_miss_cycle = m_processor->getCurrentCycle();
         return true;  // don't complete
       }
     }
 
     assert(detached());
     // otherwise we can complete now
-  } else if (isstore(m_trans_op.opcode)) { // store
+  } else if (isstore(m_opcode)) { // store
     if (m_unaligned) {
       m_processor->alignmentException(m_q_ptr);
       return true;
     }
 
-    if (m_mem_operand.getSize() == 0) {
-      assert(m_trans_op.cond == LDST_ALIGN_HI);
+    if (m_mem->m_mem_operand.getSize() == 0) {
+      assert(m_cold->m_trans_op.cond == LDST_ALIGN_HI);
       complete();
       return true;
     }
     
-    W64 value = (m_trans_op.cond == LDST_ALIGN_HI) ? (rc >> (m_mem_operand.getSize() * 8)) : rc;
+    W64 value = (m_cold->m_trans_op.cond == LDST_ALIGN_HI) ? (rc >> (m_mem->m_mem_operand.getSize() * 8)) : rc;
 	 
     // printf("uop: %d  P: %d(%x) %d\n", m_q_ptr, (unsigned)phys_addr, (unsigned)phys_addr, num_bytes);
-    m_mem_operand.setValue(value);
+    m_mem->m_mem_operand.setValue(value);
 
     LoadStoreQueue &lsq = m_processor->getLSQ();
     lsq.storeSearch(this);
 
     setStage(MEMORY_STAGE);
-    m_store_waiters.wakeupAll();
+    m_mem->m_store_waiters.wakeupAll();
 
-    if (!m_trans_op.internal) {
+    if (!m_cold->m_trans_op.internal) {
       // Issue a prefetch-exclusive for this line
-      m_processor->cacheAccess(0, REQUEST_WRITE, m_mem_operand.alignedAddr());
+      m_processor->cacheAccess(0, REQUEST_WRITE, m_mem->m_mem_operand.alignedAddr());
     }
 
     //NOTE: stores don't really complete until they retire.
     return true;
   } else{ // vanilla instruction
-    if (isbranch(m_trans_op.opcode)){
-      m_is.brreg.riptaken = m_trans_op.riptaken;
-      m_is.brreg.ripseq = m_trans_op.ripseq;
+    if (isbranch(m_opcode)){
+      m_cold->m_is.brreg.riptaken = m_cold->m_trans_op.riptaken;
+      m_cold->m_is.brreg.ripseq = m_cold->m_trans_op.ripseq;
     }
-    m_exec(m_is, ra, m_rb, rc, raflags, rbflags, rcflags);
+    m_cold->m_exec(m_cold->m_is, ra, m_mem->m_rb, rc, raflags, rbflags, rcflags);
   }
   complete();
   return true;
@@ -463,13 +537,13 @@ DynamicInst::execute() {
 
 bool
 DynamicInst::addressGenerate() { 
-  assert(isload(m_trans_op.opcode) || isstore(m_trans_op.opcode));
+  assert(isload(m_opcode) || isstore(m_opcode));
   W64 ra = m_processor->getPhysicalFile().getValue(m_ra_preg);
-  W64 rb = (m_trans_op.rb == REG_imm) ? m_trans_op.rbimm : m_processor->getPhysicalFile().getValue(m_rb_preg);
-  W64 num_bytes = 1 << m_trans_op.size;
+  W64 rb = (m_cold->m_trans_op.rb == REG_imm) ? m_cold->m_trans_op.rbimm : m_processor->getPhysicalFile().getValue(m_rb_preg);
+  W64 num_bytes = 1 << m_cold->m_trans_op.size;
 
   Waddr addr;
-  switch(m_trans_op.cond) {
+  switch(m_cold->m_trans_op.cond) {
     case LDST_ALIGN_NORMAL:
       addr = ra + rb;
       break;
@@ -484,9 +558,9 @@ DynamicInst::addressGenerate() {
   }
 
   W64 phys_addr;
-  if (!m_trans_op.internal) {
+  if (!m_cold->m_trans_op.internal) {
     if (!m_processor->translateAddress(addr, phys_addr, Sim_DI_Data)) {
-      m_processor->logNoTranslationDataMemoryOperation(*this, addr, isload(m_trans_op.opcode));
+      m_processor->logNoTranslationDataMemoryOperation(*this, addr, isload(m_opcode));
       m_processor->setOldestBad(m_q_ptr);
       return false;
     }
@@ -497,27 +571,27 @@ DynamicInst::addressGenerate() {
   
   // printf("uop: %d  P: %d(%x) %d\n", m_q_ptr, (unsigned)phys_addr, (unsigned)phys_addr, num_bytes);
 
-  size_t overflow = m_mem_operand.setAddress(phys_addr, num_bytes);
-  assert(!overflow || !m_trans_op.internal);
+  size_t overflow = m_mem->m_mem_operand.setAddress(phys_addr, num_bytes);
+  assert(!overflow || !m_cold->m_trans_op.internal);
 
-  if ((overflow != 0) && (m_trans_op.cond == LDST_ALIGN_NORMAL)) {
-    m_processor->logUnalignedDataMemoryOperation(*this, addr, isload(m_trans_op.opcode));
+  if ((overflow != 0) && (m_cold->m_trans_op.cond == LDST_ALIGN_NORMAL)) {
+    m_processor->logUnalignedDataMemoryOperation(*this, addr, isload(m_opcode));
     m_unaligned = true;
     return true;
-  } else if (m_trans_op.cond == LDST_ALIGN_LO) {
-    overflow = m_mem_operand.setAddress(phys_addr, num_bytes - overflow);
+  } else if (m_cold->m_trans_op.cond == LDST_ALIGN_LO) {
+    overflow = m_mem->m_mem_operand.setAddress(phys_addr, num_bytes - overflow);
     assert(overflow == 0);
-  } else if (m_trans_op.cond == LDST_ALIGN_HI) {
+  } else if (m_cold->m_trans_op.cond == LDST_ALIGN_HI) {
     if (overflow) {
-      overflow = m_mem_operand.setAddress(phys_addr & ~((Waddr)(1 << g_params.getMemoryBlockBits()) - 1), overflow);
+      overflow = m_mem->m_mem_operand.setAddress(phys_addr & ~((Waddr)(1 << g_params.getMemoryBlockBits()) - 1), overflow);
       assert(overflow == 0);
     } else {
-      m_mem_operand.clear();
-      assert(m_mem_operand.getSize() == 0);
+      m_mem->m_mem_operand.clear();
+      assert(m_mem->m_mem_operand.getSize() == 0);
     }
   }
 
-  if (!m_trans_op.internal) {
+  if (!m_cold->m_trans_op.internal) {
     g_stats.incrementMemoryAccesses(m_processor->getProcNum());
   }
   
@@ -530,64 +604,70 @@ DynamicInst::addressGenerate() {
 
 void 
 DynamicInst::complete() { 
-  if (isload(m_trans_op.opcode)) { // load
-    if (m_mem_operand.getSize() == 0) {
-      assert(m_trans_op.cond == LDST_ALIGN_HI);
-      m_is.reg.rddata = m_rb;
+  chargeMissStalls();
+  if (isload(m_opcode)) { // load
+    if (m_mem->m_mem_operand.getSize() == 0) {
+      assert(m_cold->m_trans_op.cond == LDST_ALIGN_HI);
+      m_cold->m_is.reg.rddata = m_mem->m_rb;
     } else {
-      DoubleWord lsq_data(m_mem_operand);
+      DoubleWord lsq_data(m_mem->m_mem_operand);
       LoadStoreQueue &lsq = m_processor->getLSQ();
-      bool needs_to_wait = !lsq.loadSearch(this, &m_mem_operand, &lsq_data);
+      bool needs_to_wait = !lsq.loadSearch(this, &m_mem->m_mem_operand, &lsq_data);
+      m_store_blocked = needs_to_wait;
 
       if (needs_to_wait) {
         assert(!detached()); // should now be waiting on a store, who will wake it up so that is can complete
         return;
       }
 
-      if (!lsq_data.covers(m_mem_operand)) {
+      if (!lsq_data.covers(m_mem->m_mem_operand)) {
         W64 load_value;
-        if (!m_trans_op.internal) {
-          load_value = m_processor->readFromSimicsMemory(m_mem_operand.addr(),
-                                                         m_mem_operand.getSize());
+        if (!m_cold->m_trans_op.internal) {
+          load_value = m_processor->readFromSimicsMemory(m_mem->m_mem_operand.addr(),
+                                                         m_mem->m_mem_operand.getSize());
         } else {
-          load_value = *((W64 *)m_mem_operand.addr());
+          load_value = *((W64 *)m_mem->m_mem_operand.addr());
         }
-        m_mem_operand.setValue(load_value);
+        m_mem->m_mem_operand.setValue(load_value);
       }
-      lsq_data.writeValue(m_mem_operand);
+      lsq_data.writeValue(m_mem->m_mem_operand);
 	 
-      m_is.reg.rddata = m_mem_operand.value();
-      if (m_trans_op.opcode == OP_ldx) {
-        m_is.reg.rddata = signext64(m_is.reg.rddata, 8 * (1 << m_trans_op.size));
-      } else if (m_trans_op.cond == LDST_ALIGN_HI) {
-        W64 num_bytes = 1 << m_trans_op.size;
-        W64 overflow = m_mem_operand.getSize();
+      m_cold->m_is.reg.rddata = m_mem->m_mem_operand.value();
+      if (m_opcode == OP_ldx) {
+        m_cold->m_is.reg.rddata = signext64(m_cold->m_is.reg.rddata, 8 * (1 << m_cold->m_trans_op.size));
+      } else if (m_cold->m_trans_op.cond == LDST_ALIGN_HI) {
+        W64 num_bytes = 1 << m_cold->m_trans_op.size;
+        W64 overflow = m_mem->m_mem_operand.getSize();
         W64 underflow = num_bytes - overflow;
-        m_is.reg.rddata = m_rb | (m_is.reg.rddata << (underflow * 8));
+        m_cold->m_is.reg.rddata = m_mem->m_rb | (m_cold->m_is.reg.rddata << (underflow * 8));
+      }
+      if (!m_cold->m_trans_op.internal) {
+        g_stats.sampleLoadToUseLatency(m_processor->getProcNum(),
+                                       m_processor->getCurrentCycle() - m_mem->m_execute_cycle);
       }
     }
-    LOG_EVENT(DEBUG_MEMORY, Box<TransOp>(m_trans_op), "Value: " << hex << m_is.reg.rddata << dec);
+    LOG_EVENT(DEBUG_MEMORY, Box<TransOp>(m_cold->m_trans_op), "Value: " << hex << m_cold->m_is.reg.rddata << dec);
   }
 
   // write rd and flags
   m_executed = true;
-  if (uopWritesDestinationRegister(m_trans_op)) {
-    if (isbranch(m_trans_op.opcode)) {
-      assert(m_trans_op.rd == REG_rip);
-      m_mispredicted = m_is.reg.rddata != m_pred_target;
-      m_processor->resolveBranch(m_q_ptr, m_is.reg.rddata);
+  if (uopWritesDestinationRegister(m_cold->m_trans_op)) {
+    if (isbranch(m_opcode)) {
+      assert(m_cold->m_trans_op.rd == REG_rip);
+      m_mispredicted = m_cold->m_is.reg.rddata != m_cold->m_pred_target;
+      m_processor->resolveBranch(m_q_ptr, m_cold->m_is.reg.rddata);
     }
-    else if(m_trans_op.rd != REG_zero) {
-      m_processor->getPhysicalFile().setValue(m_rd_preg, m_is.reg.rddata);
+    else if(m_cold->m_trans_op.rd != REG_zero) {
+      m_processor->getPhysicalFile().setValue(m_rd_preg, m_cold->m_is.reg.rddata);
     }
-    if ((m_trans_op.setflags) && (m_trans_op.rd != REG_zero)) {
-      m_processor->getPhysicalFile().setFlags(m_rd_preg, m_is.reg.rdflags);
-      m_processor->logUopExecutionResult(m_trans_op, m_is, m_is.reg.rdflags);
+    if ((m_cold->m_trans_op.setflags) && (m_cold->m_trans_op.rd != REG_zero)) {
+      m_processor->getPhysicalFile().setFlags(m_rd_preg, m_cold->m_is.reg.rdflags);
+      m_processor->logUopExecutionResult(m_cold->m_trans_op, m_cold->m_is, m_cold->m_is.reg.rdflags);
     }
   }
 
-  if (ischeck(m_trans_op.opcode) && (m_is.reg.rdflags & FLAG_INV)) {
-    assert(m_is.reg.rddata == EXCEPTION_SkipBlock);
+  if (ischeck(m_opcode) && (m_cold->m_is.reg.rdflags & FLAG_INV)) {
+    assert(m_cold->m_is.reg.rddata == EXCEPTION_SkipBlock);
 
     // if this uop already ends its x86 op, it is being replayed and no exception needs to be thrown
     if(endsX86Op()) {
@@ -598,24 +678,38 @@ DynamicInst::complete() {
     }
   }
 
-  m_processor->logStatsForUop(m_trans_op);
+  m_processor->logStatsForUop(m_cold->m_trans_op);
   setStage(COMPLETE_STAGE);
 }
 
+// Charge the retire stalls spent waiting on a miss to the level that
+// served it; a squashed miss is charged by how long it had been out.
+void
+DynamicInst::chargeMissStalls() {
+  if (m_mem->m_miss_stall_cycles > 0) {
+    Tick latency = m_processor->getCurrentCycle() - m_mem->m_miss_cycle;
+    MemorySource source = m_processor->getMemoryInterface()->getFillSource(latency);
+    CpiStack::charge(m_processor->getProcNum(), CpiStack::fromMemorySource(source),
+                     m_mem->m_miss_stall_cycles);
+    m_mem->m_miss_stall_cycles = 0;
+  }
+}
+
 bool
 DynamicInst::demandStore() {
-  if (!m_trans_op.internal) {
-    m_processor->cacheAccess(this, REQUEST_WRITE, m_mem_operand.alignedAddr());
+  if (!m_cold->m_trans_op.internal) {
+    m_processor->cacheAccess(this, REQUEST_WRITE, m_mem->m_mem_operand.alignedAddr());
     if (detached()) {  // must have succeeded immediately
       complete();
       return true;
     }
     recordEvent(inst_record_t::DCACHE_MISS);
+    m_mem->m_miss_cycle = m_processor->getCurrentCycle();
     return false;  // will succeed at some point
   } else {
     // internal "store"
-    W64 internal_value = *((W64 *)m_mem_operand.addr()) & ~m_mem_operand.mask();
-    *((W64 *)m_mem_operand.addr()) = internal_value | m_mem_operand.value();
+    W64 internal_value = *((W64 *)m_mem->m_mem_operand.addr()) & ~m_mem->m_mem_operand.mask();
+    *((W64 *)m_mem->m_mem_operand.addr()) = internal_value | m_mem->m_mem_operand.value();
     complete();
     return true;
   }
@@ -623,12 +717,18 @@ DynamicInst::demandStore() {
 
 void 
 DynamicInst::completeAtDecode() {
-  if (m_record) { 
+  if (m_recorded) { 
     QPointer cycle = m_processor->getCurrentCycle();
-    m_record->Set(inst_record_t::DECODE_STAGE, cycle);
-    m_record->Set(inst_record_t::QUEUE_STAGE, cycle);
-    m_record->Set(inst_record_t::READY_STAGE, cycle);
-    m_record->Set(inst_record_t::EXECUTE_STAGE, cycle);
+    m_cold->m_record->Set(inst_record_t::DECODE_STAGE, cycle);
+    m_cold->m_record->Set(inst_record_t::QUEUE_STAGE, cycle);
+    m_cold->m_record->Set(inst_record_t::READY_STAGE, cycle);
+    m_cold->m_record->Set(inst_record_t::EXECUTE_STAGE, cycle);
+  }
+  if (m_processor->getPipeTrace().isOpen()) {
+    Tick cycle = m_processor->getCurrentCycle();
+    m_cold->m_stage_cycle[DECODE_STAGE] = cycle;
+    m_cold->m_stage_cycle[WAIT_RA_STAGE] = cycle;
+    m_cold->m_stage_cycle[EXECUTE_STAGE] = cycle;
   }
   m_executed = true;
   setStage(COMPLETE_STAGE);
@@ -656,9 +756,9 @@ DynamicInst::commit() {
     physical_file.decrementRefCount(m_rc_preg);
   }
   if (m_rd_preg != REG_NULL_DEST) {
-    // printf("free old rdflags: %d\n", m_trans_op.rdflags_preg_old);
-    if (m_trans_op.setflags && !m_trans_op.nouserflags) {
-      W64 flagmask = setflags_to_x86_flags[m_trans_op.setflags];
+    // printf("free old rdflags: %d\n", m_cold->m_trans_op.rdflags_preg_old);
+    if (m_user_flags) {
+      W64 flagmask = m_user_flags;
       if(flagmask & FLAG_OF) {
         retire_map.setMapping(REG_of, m_rd_preg);
         physical_file.decrementRefCount(m_rof_preg_old);
@@ -673,8 +773,8 @@ DynamicInst::commit() {
       }
     }
 
-    // printf("free old rd: %d\n", m_trans_op.m_rd_preg_old);
-    retire_map.setMapping(m_trans_op.rd, m_rd_preg);
+    // printf("free old rd: %d\n", m_cold->m_trans_op.m_rd_preg_old);
+    retire_map.setMapping(m_rd, m_rd_preg);
     physical_file.decrementRefCount(m_rd_preg_old);
   }
 }
@@ -700,27 +800,29 @@ DynamicInst::setCheckException() {
 
 bool 
 DynamicInst::isMemoryInst() {
-  return isload(m_trans_op.opcode) || isstore(m_trans_op.opcode);
+  return isload(m_opcode) || isstore(m_opcode);
 }
 
 void 
 DynamicInst::setRecord(real_inst_record_t *r) { 
   assert(r); 
   r->SetPC(m_rip);
-  m_record = r; 
+  m_cold->m_record = r; 
+  m_recorded = true;
 }
 
 real_inst_record_t *
 DynamicInst::getRecord() { 
-  real_inst_record_t *ret_val = m_record;
-  m_record = 0;
+  real_inst_record_t *ret_val = m_cold->m_record;
+  m_cold->m_record = 0;
+  m_recorded = false;
   return ret_val; 
 }
 
 void 
 DynamicInst::recordEvent(inst_record_t::event_t e) {
-  if (m_record) {
-    m_record->AddEvent(e);
+  if (m_recorded) {
+    m_cold->m_record->AddEvent(e);
   }
 }
 
@@ -734,15 +836,15 @@ DynamicInst::readRegisters(W64& ra, W64& rb, W64& rc,
   ra = m_processor->getPhysicalFile().getValue(m_ra_preg);
   raflags = m_processor->getPhysicalFile().getFlags(m_ra_preg);
 
-  if (m_trans_op.rb == REG_imm){
-    rb = m_trans_op.rbimm;
+  if (m_cold->m_trans_op.rb == REG_imm){
+    rb = m_cold->m_trans_op.rbimm;
   } else{
     rb = m_processor->getPhysicalFile().getValue(m_rb_preg);
     rbflags = m_processor->getPhysicalFile().getFlags(m_rb_preg);
   }
 
-  if (m_trans_op.rc == REG_imm) {
-    rc = m_trans_op.rcimm;
+  if (m_cold->m_trans_op.rc == REG_imm) {
+    rc = m_cold->m_trans_op.rcimm;
   } else {
     rc = m_processor->getPhysicalFile().getValue(m_rc_preg);
     rcflags = m_processor->getPhysicalFile().getFlags(m_rc_preg);
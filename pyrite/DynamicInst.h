@@ -46,11 +46,43 @@ enum StageType {FETCH_STAGE, DECODE_STAGE, WAIT_RA_STAGE,
 /********************* Dynamic Instruction ***********************/
 /*****************************************************************/
 
+//! The instruction window is laid out as parallel per-slot arrays
+//! (see Processor): the DynamicInst itself holds only what the
+//! scheduler, LSQ and retire loops look at, the memory record what a
+//! memory uop needs while it executes, and the cold record everything
+//! else.  Hot loops must not touch the cold record.
+
+//! per-slot memory state, used by loads and stores in flight
+struct DynamicInstMemory {
+  DoubleWord m_mem_operand;
+  WaitList m_store_waiters;   // loads waiting on this store's data
+  Tick m_execute_cycle;       // when the uop began executing, for load-to-use latency
+  Tick m_miss_cycle;          // when its outstanding cache miss was issued
+  W32 m_miss_stall_cycles;    // retire stalls on that miss not yet charged
+  W64 m_rb;                   // rb operand, kept for a split load's high half
+};
+
+//! per-slot cold state, only read when a uop is renamed, executed,
+//! committed, recorded or traced
+struct DynamicInstCold {
+  TransOp m_trans_op;
+  Waddr m_pred_target;
+  uopimpl_func_t m_exec;
+  IssueState m_is;
+  Tick m_stage_cycle[MAX_STAGES];
+  W64 m_seq_num;              // fetch order, unlike m_q_ptr never reused
+  W8 m_uop_num;               // position in its x86 op
+  real_inst_record_t *m_record;
+};
+
 class DynamicInst : public Waiter {
 public:
-  DynamicInst() : m_record(0) { reset(); }
+  DynamicInst() : m_mem(0), m_cold(0), m_recorded(false) { }
   DynamicInst(const DynamicInst &rhs) { assert(0); }
 
+  //! binds the instruction to its window slot's memory and cold records
+  void attach(DynamicInstMemory *mem, DynamicInstCold *cold);
+
   void init(Processor *procesor, const TransOp &trans_op, Waddr rip, /*X86Op *x86_op,*/
             uopimpl_func_t exec, QPointer q_ptr, W8 latency);
   void reset();
@@ -69,9 +101,19 @@ public:
   QPointer getQPointer() const { return m_q_ptr; }
   Waddr getRIP() const { return m_rip; }
 
+  /* pipeline trace related (see PipeTrace.h) */
+  void setUopNum(W8 uop_num) { m_cold->m_uop_num = uop_num; }
+  W8 getUopNum() const { return m_cold->m_uop_num; }
+  void setSeqNum(W64 seq_num) { m_cold->m_seq_num = seq_num; }
+  W64 getSeqNum() const { return m_cold->m_seq_num; }
+  //! the cycle the uop entered stage, 0 if it has not (only kept while tracing)
+  Tick getStageCycle(StageType stage) const { return m_cold->m_stage_cycle[stage]; }
+
   void squash();
   void unwindRegisters();
 
+  //! renaming takes a new physical register for rd
+  bool allocatesRegister();
   void rename();
   void queue();
   void schedule();
@@ -91,21 +133,30 @@ public:
   bool hasCheckException() { return m_check_exception; }
 
   bool isMemoryInst();
-  bool isInternal() { return m_trans_op.internal; }
+  bool isInternal() { return m_cold->m_trans_op.internal; }
 
   /* record related */
   void setRecord(real_inst_record_t *r);
-  real_inst_record_t *peekRecord() { return m_record; }
+  real_inst_record_t *peekRecord() { return m_cold->m_record; }
   real_inst_record_t *getRecord();
   void recordEvent(inst_record_t::event_t e);
 
   W8 getLatency() const { return m_latency; }
-  byte getOpcode() const { return m_trans_op.opcode; }
-  const DoubleWord *getMemOperand() const { return &m_mem_operand; }
-  const TransOp *getTransOp() const { return &m_trans_op; }
-
-  void insertStoreWaiter(Waiter *store_waiter) { m_store_waiters.insertWaiter(store_waiter); }
-  void setPredTarget(Waddr pred_target) { m_pred_target = pred_target; }
+  byte getOpcode() const { return m_opcode; }
+  W16 getUserFlags() const { return m_user_flags; }
+  const DoubleWord *getMemOperand() const { return &m_mem->m_mem_operand; }
+  const TransOp *getTransOp() const { return &m_cold->m_trans_op; }
+
+  void insertStoreWaiter(Waiter *store_waiter) { m_mem->m_store_waiters.insertWaiter(store_waiter); }
+  bool isStoreBlocked() const { return m_store_blocked; }
+
+  //! a cache miss is outstanding; while the uop is the oldest, retire
+  //! counts the cycles it stalls and they are charged to the CPI stack
+  //! (CpiStack.h) once the fill says where the line came from
+  bool isMissOutstanding() const { return (m_stage == MEMORY_STAGE) && waiting() && !m_store_blocked; }
+  void addMissStallCycle() { ++ m_mem->m_miss_stall_cycles; }
+  void setPredTarget(Waddr pred_target) { m_cold->m_pred_target = pred_target; }
+  Waddr getPredTarget() const { return m_cold->m_pred_target; }
   bool isMispredicted() const { return m_mispredicted; }
   bool isLSQInserted() const { return m_lsq_inserted; }
 
@@ -118,10 +169,20 @@ public:
   DynamicInst &operator= (const DynamicInst &rhs);
 
 private:
+  void waitForRegister(PhysName preg);
+
   void readRegisters(W64& ra, W64& rb, W64& rc, 
                      W16& raflags, W16& rbflags, W16& rcflags);
+  void chargeMissStalls();
 
-  TransOp m_trans_op;
+  // hot: everything the scheduler, LSQ and retire loops read
+  QPointer m_q_ptr;
+  StageType m_stage;
+  byte m_opcode;              // copy of m_trans_op.opcode
+  byte m_rd;                  // copy of m_trans_op.rd
+  W8 m_latency;
+  W16 m_user_flags;           // x86 flags the uop sets, 0 with nouserflags
+  Waddr m_rip;
 
   bool m_executed;
   bool m_lsq_inserted;
@@ -132,12 +193,10 @@ private:
   bool m_check_exception;
   bool m_starts_x86_op;
   bool m_ends_x86_op;
+  bool m_store_blocked;       // load waiting on an older store's data
+  bool m_recorded;            // the cold record holds an inst_record
 
-  Waddr m_rip;
-  Waddr m_pred_target;
-  W8 m_latency;
-
-  QPointer m_q_ptr;
+  PhysName m_waiting_preg;    // source register it is a consumer of, if any
   PhysName m_ra_preg;
   PhysName m_rb_preg;
   PhysName m_rc_preg;
@@ -146,16 +205,10 @@ private:
   PhysName m_rcf_preg_old;    // the previous mapping for cf
   PhysName m_rof_preg_old;    // the previous mapping for of
   PhysName m_rzapsf_preg_old; // the previous mapping for zapsf
-  DoubleWord m_mem_operand;
-  uopimpl_func_t m_exec;
-  IssueState m_is;
-  W64 m_rb;
-  WaitList m_store_waiters;
-  
-  Processor *m_processor;
 
-  StageType m_stage;
-  real_inst_record_t *m_record;
+  Processor *m_processor;
+  DynamicInstMemory *m_mem;
+  DynamicInstCold *m_cold;
 };
 
 #endif // __DYNAMIC_INST_H
@@ -0,0 +1,210 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+
+//===-- IntervalStats.cpp - time series of the scalar stats ------*- C++ -*--=//
+//
+//! The interval ring and its writer thread.
+//
+//===----------------------------------------------------------------------===//
+
+#include <string.h>
+#include "IntervalStats.h"
+#include "stats.h"
+
+static const char INTERVAL_STATS_MAGIC[8] = "PYRITIV";
+static const W32 INTERVAL_STATS_VERSION = 1;
+
+IntervalStats g_interval_stats;
+
+IntervalStats::IntervalStats()
+  : m_file(NULL), m_json(false), m_interval(0), m_countdown(0), m_num_fields(0),
+    m_record_size(0), m_ring_size(0), m_head(0), m_tail(0), m_closing(false) {
+}
+
+IntervalStats::~IntervalStats() {
+  if (isOpen()) {
+    close();
+  }
+}
+
+void
+IntervalStats::open(const std::string& filename, W64 interval, int ring_size) {
+  assert(!isOpen());
+  if ((interval == 0) || (ring_size <= 0)) {
+    ERROR_MSG("Interval stats need a positive interval and ring size");
+  }
+  m_file = fopen(filename.c_str(), "w");
+  if (m_file == NULL) {
+    ERROR_MSG("Unable to open interval stats file " + filename);
+  }
+  m_json = (filename.size() >= 6) && (filename.compare(filename.size() - 6, 6, ".jsonl") == 0);
+
+  m_interval = interval;
+  m_countdown = interval;
+  m_num_fields = g_stats.getNumIntervalFields();
+  m_record_size = 1 + m_num_fields;
+  m_previous.resize(m_num_fields);
+  m_current.resize(m_num_fields);
+  g_stats.snapshotIntervalFields(&m_previous[0]);
+
+  m_ring_size = ring_size;
+  m_ring.resize(m_ring_size * m_record_size);
+  m_head = m_tail = 0;
+  m_closing = false;
+  writeHeader();
+
+  pthread_mutex_init(&m_mutex, NULL);
+  pthread_cond_init(&m_not_empty, NULL);
+  pthread_cond_init(&m_not_full, NULL);
+  if (pthread_create(&m_thread, NULL, writerThread, this) != 0) {
+    ERROR_MSG("Unable to start the interval stats writer thread");
+  }
+}
+
+void
+IntervalStats::close() {
+  assert(isOpen());
+  pthread_mutex_lock(&m_mutex);
+  m_closing = true;
+  pthread_cond_signal(&m_not_empty);
+  pthread_mutex_unlock(&m_mutex);
+  pthread_join(m_thread, NULL);
+  pthread_mutex_destroy(&m_mutex);
+  pthread_cond_destroy(&m_not_empty);
+  pthread_cond_destroy(&m_not_full);
+
+  if (fclose(m_file) != 0) {
+    ERROR_MSG("Error closing interval stats file");
+  }
+  m_file = NULL;
+}
+
+void
+IntervalStats::sample(W64 cycle) {
+  assert(isOpen());
+  m_countdown = m_interval;
+
+  //! only the writer thread can free a slot, so it is safe to fill
+  //! the slot at m_head without holding the lock
+  pthread_mutex_lock(&m_mutex);
+  while (m_head - m_tail == (W64) m_ring_size) {
+    pthread_cond_wait(&m_not_full, &m_mutex);
+  }
+  pthread_mutex_unlock(&m_mutex);
+
+  integer_t* record = &m_ring[(m_head % m_ring_size) * m_record_size];
+  record[0] = cycle;
+  g_stats.snapshotIntervalFields(&m_current[0]);
+  for (int i = 0 ; i < m_num_fields ; i++) {
+    record[1 + i] = m_current[i] - m_previous[i];
+  }
+  m_previous.swap(m_current);
+
+  pthread_mutex_lock(&m_mutex);
+  m_head++;
+  pthread_cond_signal(&m_not_empty);
+  pthread_mutex_unlock(&m_mutex);
+}
+
+void
+IntervalStats::writeHeader() {
+  Vector<string> names;
+  g_stats.getIntervalFieldNames(names);
+  assert(names.size() == m_num_fields);
+
+  if (m_json) {
+    fprintf(m_file, "{\"interval\": %llu, \"fields\": [\"cycle\"", m_interval);
+    for (int i = 0 ; i < names.size() ; i++) {
+      fprintf(m_file, ", \"%s\"", names[i].c_str());
+    }
+    fprintf(m_file, "]}\n");
+  } else {
+    IntervalStatsHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.m_magic, INTERVAL_STATS_MAGIC, sizeof(header.m_magic));
+    header.m_version = INTERVAL_STATS_VERSION;
+    header.m_num_fields = m_num_fields;
+    header.m_interval = m_interval;
+    fwrite(&header, sizeof(header), 1, m_file);
+    for (int i = 0 ; i < names.size() ; i++) {
+      fwrite(names[i].c_str(), 1, names[i].size() + 1, m_file);
+    }
+  }
+  flushFile();
+}
+
+void
+IntervalStats::writeRecord(const integer_t* record) {
+  if (m_json) {
+    fprintf(m_file, "[%lld", record[0]);
+    for (int i = 1 ; i < m_record_size ; i++) {
+      fprintf(m_file, ", %lld", record[i]);
+    }
+    fprintf(m_file, "]\n");
+  } else {
+    fwrite(record, sizeof(integer_t), m_record_size, m_file);
+  }
+}
+
+//! stdio keeps the error flag until cleared, so one check after each
+//! batch catches a short fwrite or failed fprintf (e.g. a full disk)
+void
+IntervalStats::flushFile() {
+  if ((fflush(m_file) != 0) || ferror(m_file)) {
+    ERROR_MSG("Error writing interval stats file");
+  }
+}
+
+void*
+IntervalStats::writerThread(void* stats) {
+  ((IntervalStats*) stats)->writeLoop();
+  return NULL;
+}
+
+void
+IntervalStats::writeLoop() {
+  while (true) {
+    pthread_mutex_lock(&m_mutex);
+    while ((m_head == m_tail) && !m_closing) {
+      pthread_cond_wait(&m_not_empty, &m_mutex);
+    }
+    W64 head = m_head;
+    W64 tail = m_tail;
+    bool closing = m_closing;
+    pthread_mutex_unlock(&m_mutex);
+
+    if (head == tail) {
+      assert(closing);
+      return;
+    }
+
+    //! records [tail, head) stay put until m_tail moves past them
+    for (W64 i = tail ; i < head ; i++) {
+      writeRecord(&m_ring[(i % m_ring_size) * m_record_size]);
+    }
+    flushFile();
+
+    pthread_mutex_lock(&m_mutex);
+    m_tail = head;
+    pthread_cond_signal(&m_not_full);
+    pthread_mutex_unlock(&m_mutex);
+  }
+}
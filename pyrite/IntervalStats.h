@@ -0,0 +1,111 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+
+//===-- IntervalStats.h - time series of the scalar stats --------*- C++ -*--=//
+//
+//! IntervalStats records, every N simulated cycles, how much each
+//! STAT_INT of def/stats.def changed during the interval.  A record is
+//! the current cycle followed by one delta per field, in the order of
+//! Stats::getIntervalFieldNames().  Records go into a preallocated ring
+//! and a helper thread writes them out, so sampling costs a copy and a
+//! subtraction per field.  Clearing the stats shows up as negative
+//! deltas.
+//!
+//! Files whose name ends in ".jsonl" get JSON lines: a header object
+//! {"interval": N, "fields": ["cycle", ...]} followed by one array per
+//! record.  Any other name gets the binary layout (host byte order):
+//!   IntervalStatsHeader
+//!   m_num_fields NUL-terminated field names
+//!   records of (1 + m_num_fields) int64
+//! tools/bin/intervals2csv.py converts either to CSV.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef __INTERVAL_STATS_H
+#define __INTERVAL_STATS_H
+
+#include <stdio.h>
+#include <pthread.h>
+#include <string>
+#include <vector>
+#include "globals.h"
+#include "Global.h"
+
+struct IntervalStatsHeader {
+  char m_magic[8];      //!< "PYRITIV" plus a NUL
+  W32 m_version;
+  W32 m_num_fields;     //!< not counting the cycle
+  W64 m_interval;       //!< cycles per record
+};
+
+class IntervalStats {
+public:
+  IntervalStats();
+  ~IntervalStats();
+
+  //! start recording every interval cycles; ring_size records may be
+  //! waiting for the writer before sample() blocks
+  void open(const std::string& filename, W64 interval, int ring_size);
+  //! write out everything recorded so far and stop
+  void close();
+  bool isOpen() const { return m_file != NULL; }
+
+  //! called once per simulated cycle; true when sample() is due
+  bool isDue() { return (m_file != NULL) && (--m_countdown == 0); }
+  //! record the deltas since the previous sample
+  void sample(W64 cycle);
+
+  //! entry point of the writer thread
+  static void* writerThread(void* stats);
+
+private:
+  void writeHeader();
+  void writeRecord(const integer_t* record);
+  void flushFile();
+  void writeLoop();
+
+  // Private copy constructor and assignment operator
+  IntervalStats(const IntervalStats& obj);
+  IntervalStats& operator=(const IntervalStats& obj);
+
+  FILE* m_file;
+  bool m_json;
+  W64 m_interval, m_countdown;
+  int m_num_fields;
+  int m_record_size;                  //!< the cycle plus m_num_fields
+  std::vector<integer_t> m_previous;  //!< stats at the previous sample
+  std::vector<integer_t> m_current;
+
+  //! m_ring holds m_ring_size records; records [m_tail, m_head) are
+  //! waiting for the writer thread
+  std::vector<integer_t> m_ring;
+  int m_ring_size;
+  W64 m_head, m_tail;
+  bool m_closing;
+  pthread_t m_thread;
+  pthread_mutex_t m_mutex;
+  pthread_cond_t m_not_empty;
+  pthread_cond_t m_not_full;
+};
+
+extern IntervalStats g_interval_stats;
+
+#endif  /* __INTERVAL_STATS_H */
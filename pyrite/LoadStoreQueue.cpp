@@ -38,6 +38,18 @@ LoadStoreQueue::reset() {  // called when we flush the whole pipeline.  ("Nuke i
   m_loadStoreMap.clear();
 }
 
+void 
+LoadStoreQueue::reportHostMemory() const {
+  // red-black tree nodes carry a color and three links, list nodes two links
+  const size_t map_node = sizeof(LoadStoreMap::value_type) + 4 * sizeof(void *);
+  const size_t list_node = sizeof(DynamicInst *) + 2 * sizeof(void *);
+  int64 bytes = m_loadStoreMap.size() * map_node;
+  for (LoadStoreMap::const_iterator i = m_loadStoreMap.begin() ; i != m_loadStoreMap.end() ; ++ i) {
+    bytes += i->second.size() * list_node;
+  }
+  HostMemory::report(HOST_MEMORY_LSQ, bytes);
+}
+
 void 
 LoadStoreQueue::insert(DynamicInst *inst) {
   assert(isstore(inst->getOpcode()) || isload(inst->getOpcode()));
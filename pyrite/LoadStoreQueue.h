@@ -32,11 +32,12 @@
 #include <map>
 #include <list>
 #include <iostream>
+#include "HostMemory.h"
 
 class DynamicInst;
 class DoubleWord;
 
-class LoadStoreQueue {
+class LoadStoreQueue : public HostMemoryReporter {
   typedef std::list<DynamicInst *> LoadStoreList;
   typedef std::map<Waddr, LoadStoreList> LoadStoreMap;
 
@@ -54,6 +55,9 @@ public:
 
   bool empty() const { return m_loadStoreMap.empty(); }
 
+  //! estimated bytes of the map and list nodes
+  void reportHostMemory() const;
+
 private:
   LoadStoreMap m_loadStoreMap;
 };
@@ -17,7 +17,9 @@
 //
 // ----------------------------------------------------------------------
 
+#include "Processor.h"
 #include "MemoryInterface.h"
+#include "params.h"
 
 void
 MemoryRequestRetry::wakeup() {
@@ -54,11 +56,34 @@ MemoryInterface::fillRequest(Waddr fill_addr) {
   if (m_requested_lines.find(fill_addr) != m_requested_lines.end()) {
     MissedLineWaitList *requested_line_waitlist = m_requested_lines[fill_addr];
     m_requested_lines.erase(fill_addr);
+    m_fill_source = requested_line_waitlist->getSource();
+    if (m_fill_source == SOURCE_NONE) {
+      m_fill_source = classifyLatency(m_processor->getCurrentCycle() -
+                                      requested_line_waitlist->getIssueCycle());
+    }
     requested_line_waitlist->wakeupAll();
+    m_fill_source = SOURCE_NONE;
     delete requested_line_waitlist;
   }
 }
 
+MemorySource
+MemoryInterface::getFillSource(Tick latency) const {
+  return (m_fill_source != SOURCE_NONE) ? m_fill_source : classifyLatency(latency);
+}
+
+MemorySource
+MemoryInterface::classifyLatency(Tick latency) const {
+  if (latency == 0) {
+    return SOURCE_L1;
+  } else if (latency <= (Tick)g_params.getCpiL2Cycles()) {
+    return SOURCE_L2;
+  } else if (latency < (Tick)g_params.getCpiDramCycles()) {
+    return SOURCE_DIRECTORY;
+  }
+  return SOURCE_DRAM;
+}
+
 void 
 MemoryInterface::releaseAllWaiters() {
   for(std::map<Waddr, MissedLineWaitList *>::const_iterator iter = m_requested_lines.begin();
@@ -30,12 +30,16 @@
 
 #include <map>
 #include "Waiter.h"
+#include "Event.h"
 
 class MemoryInterface;
 class Processor;
 
 enum RequestType {NO_REQUEST, REQUEST_READ, REQUEST_WRITE};
 
+//! where the data of a filled request came from
+enum MemorySource {SOURCE_NONE, SOURCE_L1, SOURCE_L2, SOURCE_DIRECTORY, SOURCE_DRAM};
+
 class MemoryRequestRetry : public Waiter {
 public:
   MemoryRequestRetry(MemoryInterface *mem_interface, Waddr request_addr,
@@ -60,17 +64,24 @@ private:
 
 class MissedLineWaitList : public WaitList {
 public:
-  MissedLineWaitList(RequestType request_type) : m_request_type(request_type) {};
+  MissedLineWaitList(RequestType request_type, Tick issue_cycle,
+                     MemorySource source = SOURCE_NONE)
+    : m_request_type(request_type), m_issue_cycle(issue_cycle), m_source(source) {};
 
   RequestType getRequestType() const { return m_request_type; }
+  Tick getIssueCycle() const { return m_issue_cycle; }
+  //! SOURCE_NONE if the memory model only finds out when the line arrives
+  MemorySource getSource() const { return m_source; }
 private:
   RequestType m_request_type;
+  Tick m_issue_cycle;
+  MemorySource m_source;
 };
 
 class MemoryInterface {
 public:
   MemoryInterface(Processor *processor)
-    : m_processor(processor), m_requested_lines(),
+    : m_processor(processor), m_requested_lines(), m_fill_source(SOURCE_NONE),
       m_primary_misses(0), m_secondary_misses(0), m_miss_collisions(0) {};
 
   virtual void reset();
@@ -79,12 +90,24 @@ public:
   virtual void request(Waddr addr, RequestType type, Waiter *requester) = 0;
   virtual bool ready() const { return true; }
 
+  //! functional warming: bring the line into the caches as the access
+  //! would, without timing and without waking anybody
+  virtual void warm(Waddr addr, RequestType type, bool ifetch) {}
+
   virtual void releaseAllWaiters();
 
+  //! where a miss that took latency cycles was served from: the source of
+  //! the fill being delivered when called from one of its waiters,
+  //! otherwise a guess from the latency alone
+  MemorySource getFillSource(Tick latency) const;
+
 protected:
+  MemorySource classifyLatency(Tick latency) const;
+
   Processor *m_processor;
 
   std::map<Waddr, MissedLineWaitList *> m_requested_lines;
+  MemorySource m_fill_source;  //!< only set while fillRequest() wakes waiters
 
   /* stats */
   unsigned m_primary_misses;
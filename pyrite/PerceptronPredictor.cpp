@@ -0,0 +1,151 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+//===-- PerceptronPredictor.cpp - hashed perceptron predictor ----*- C++ -*--=//
+//
+//! The hashed perceptron predictor; see PerceptronPredictor.h.
+//
+//===----------------------------------------------------------------------===//
+
+#include <stdlib.h>
+#include "PerceptronPredictor.h"
+#include "Checkpoint.h"
+
+//! history lengths of tables 1 and up
+static const int HISTORY_LENGTHS[PerceptronPredictor::NUM_TABLES - 1] = {3, 6, 10, 16, 25, 40, 64};
+
+PerceptronPredictor::PerceptronPredictor(unsigned window_size)
+  : m_threshold((int) (1.93 * NUM_TABLES + 14)), m_tc(0),
+    m_history(MAX_HISTORY, window_size), m_inflights(window_size) {
+  m_fold[0] = -1;
+  for (int i = 1 ; i < NUM_TABLES ; i ++) {
+    m_fold[i] = m_history.addFold(HISTORY_LENGTHS[i - 1], TABLE_BITS);
+  }
+  for (int i = 0 ; i < NUM_TABLES ; i ++) {
+    m_weights[i].resize(1 << TABLE_BITS, 0);
+  }
+  m_committed_history = m_history.getState();
+}
+
+bool
+PerceptronPredictor::predict(Waddr rip, QPointer q_ptr) {
+  Record &record = m_inflights.save(q_ptr);
+  record.m_history = m_history.getState();
+  record.m_rip = rip;
+
+  unsigned pc = (unsigned) rip;
+  record.m_sum = 0;
+  for (int i = 0 ; i < NUM_TABLES ; i ++) {
+    unsigned index = pc ^ (pc >> (TABLE_BITS - i));
+    if (i > 0) {
+      index ^= m_history.getFold(m_fold[i]);
+    }
+    record.m_index[i] = index & ((1 << TABLE_BITS) - 1);
+    record.m_sum += m_weights[i][record.m_index[i]];
+  }
+
+  record.m_pred = record.m_dir = (record.m_sum >= 0);
+  m_history.push(record.m_pred, rip);
+  return record.m_pred;
+}
+
+void
+PerceptronPredictor::resolve(QPointer q_ptr, bool taken) {
+  m_inflights.get(q_ptr).m_dir = taken;
+}
+
+void
+PerceptronPredictor::squash(QPointer first_bad) {
+  m_inflights.squash(first_bad);
+  if (m_inflights.empty()) {
+    m_history.setState(m_committed_history);
+  } else {
+    const Record &record = m_inflights.youngest();
+    m_history.setState(record.m_history);
+    m_history.push(record.m_dir, record.m_rip);
+  }
+}
+
+void
+PerceptronPredictor::commit(QPointer q_ptr) {
+  const Record &record = m_inflights.get(q_ptr);
+  bool taken = record.m_dir;
+
+  if ((record.m_pred != taken) || (abs(record.m_sum) <= m_threshold)) {
+    for (int i = 0 ; i < NUM_TABLES ; i ++) {
+      signed char &weight = m_weights[i][record.m_index[i]];
+      if (taken && (weight < 127)) {
+        ++ weight;
+      } else if (!taken && (weight > -127)) {
+        -- weight;
+      }
+    }
+
+    // raise the threshold when mispredictions dominate, lower it when
+    // confident-enough updates do
+    if (record.m_pred != taken) {
+      if (++ m_tc > 63) {
+        ++ m_threshold;
+        m_tc = 0;
+      }
+    } else if (-- m_tc < -64) {
+      m_threshold = std::max(m_threshold - 1, 1);
+      m_tc = 0;
+    }
+  }
+
+  m_committed_history = record.m_history;
+  m_history.push(m_committed_history, taken, record.m_rip);
+  m_inflights.commit(q_ptr);
+}
+
+void
+PerceptronPredictor::checkpoint(CheckpointWriter& cp) const {
+  cp.write(NUM_TABLES);
+  cp.write(TABLE_BITS);
+  for (int i = 0 ; i < NUM_TABLES ; i ++) {
+    cp.writeArray(&m_weights[i][0], m_weights[i].size());
+  }
+  cp.write(m_threshold);
+  cp.write(m_tc);
+  m_history.checkpoint(cp, m_committed_history);
+}
+
+void
+PerceptronPredictor::restore(CheckpointReader& cp) {
+  cp.check(NUM_TABLES, "perceptron tables");
+  cp.check(TABLE_BITS, "perceptron table bits");
+  for (int i = 0 ; i < NUM_TABLES ; i ++) {
+    cp.readArray(&m_weights[i][0], m_weights[i].size());
+  }
+  cp.read(m_threshold);
+  cp.read(m_tc);
+  m_history.restore(cp);
+  m_committed_history = m_history.getState();
+  m_inflights.clear();
+}
+
+void
+PerceptronPredictor::warm(Waddr rip, bool taken) {
+  assert(m_inflights.empty());
+  predict(rip, 0);
+  resolve(0, taken);
+  commit(0);
+}
@@ -0,0 +1,75 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+//===-- PerceptronPredictor.h - hashed perceptron predictor ------*- C++ -*--=//
+//
+//! A hashed perceptron direction predictor (Tarjan and Skadron): each
+//! table holds signed weights indexed by the branch address hashed
+//! with a global history segment of its own length, and the branch is
+//! predicted taken if the weights sum to at least zero.  The weights
+//! train when the prediction was wrong or not confident, against a
+//! threshold that adapts as in O-GEHL.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef __PERCEPTRON_PREDICTOR_H
+#define __PERCEPTRON_PREDICTOR_H
+
+#include <vector>
+#include "Predictor.h"
+#include "BranchHistory.h"
+
+class PerceptronPredictor : public DirectPredictor {
+public:
+  PerceptronPredictor(unsigned window_size);
+
+  bool predict(Waddr rip, QPointer q_ptr);
+  void resolve(QPointer q_ptr, bool taken);
+  void squash(QPointer first_bad);
+  void commit(QPointer q_ptr);
+  void checkpoint(CheckpointWriter& cp) const;
+  void restore(CheckpointReader& cp);
+  void warm(Waddr rip, bool taken);
+
+  //! table 0 is indexed by the address alone
+  static const int NUM_TABLES = 8;
+  static const int TABLE_BITS = 11;
+  static const int MAX_HISTORY = 64;
+
+private:
+  struct Record {
+    GlobalHistory::State m_history;  // before this branch
+    Waddr m_rip;
+    bool m_pred;
+    bool m_dir;                 // predicted, then resolved direction
+    unsigned m_index[NUM_TABLES];
+    int m_sum;
+  };
+
+  int m_fold[NUM_TABLES];
+  std::vector<signed char> m_weights[NUM_TABLES];
+  int m_threshold, m_tc;
+
+  GlobalHistory m_history;
+  GlobalHistory::State m_committed_history;
+  SquashableRing<Record> m_inflights;
+};
+
+#endif /* __PERCEPTRON_PREDICTOR_H */
@@ -0,0 +1,125 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+//===-- PipeTrace.cpp - O3PipeView pipeline trace ---------------*- C++ -*--=//
+//
+//! Formats the O3PipeView records.
+//
+//===----------------------------------------------------------------------===//
+
+#include <stdio.h>
+#include <fstream>
+#include <set>
+#include "PipeTrace.h"
+#include "DynamicInst.h"
+#include "gzstream.h"
+#include "Global.h"
+
+static const size_t PIPE_TRACE_BUFFER_SIZE = 1 << 20;
+
+// Processors are never deleted, so whatever is still open is closed at
+// exit; a gzip trace is unreadable without its trailer.
+static std::set<PipeTrace *> s_open_traces;
+
+static struct PipeTraceCloser {
+  ~PipeTraceCloser() {
+    while (!s_open_traces.empty()) {
+      (*s_open_traces.begin())->close();
+    }
+  }
+} s_pipe_trace_closer;
+
+PipeTrace::PipeTrace()
+  : m_out(NULL), m_start_cycle(0), m_end_cycle(0),
+    m_start_instruction(0), m_end_instruction(0) {
+}
+
+PipeTrace::~PipeTrace() {
+  if (isOpen()) {
+    close();
+  }
+}
+
+void
+PipeTrace::open(const std::string& filename, bool gzip, Tick start_cycle, Tick end_cycle,
+                W64 start_instruction, W64 end_instruction) {
+  assert(!isOpen());
+  if (gzip) {
+    ogzstream *out = new ogzstream(filename.c_str());
+    m_out = out;
+  } else {
+    std::ofstream *out = new std::ofstream();
+    m_buffer.resize(PIPE_TRACE_BUFFER_SIZE);
+    out->rdbuf()->pubsetbuf(&m_buffer[0], m_buffer.size());
+    out->open(filename.c_str());
+    m_out = out;
+  }
+  if (!m_out->good()) {
+    ERROR_MSG("can't open pipeline trace file " + filename);
+  }
+  m_start_cycle = start_cycle;
+  m_end_cycle = end_cycle;
+  m_start_instruction = start_instruction;
+  m_end_instruction = end_instruction;
+  s_open_traces.insert(this);
+}
+
+void
+PipeTrace::close() {
+  assert(isOpen());
+  m_out->flush();
+  delete m_out;  // closes the file, writing the gzip trailer
+  m_out = NULL;
+  m_buffer.clear();
+  s_open_traces.erase(this);
+}
+
+void
+PipeTrace::record(const DynamicInst &inst, Tick retire_cycle, W64 committed) {
+  Tick fetch = inst.getStageCycle(FETCH_STAGE);
+  if ((fetch < m_start_cycle) || ((m_end_cycle != 0) && (fetch >= m_end_cycle)) ||
+      (committed < m_start_instruction) ||
+      ((m_end_instruction != 0) && (committed >= m_end_instruction))) {
+    return;
+  }
+
+  // a squashed uop has no retire, and only a retired store writes memory
+  Tick store = ((retire_cycle != 0) && isstore(inst.getOpcode())) ? retire_cycle : 0;
+
+  *m_out << "O3PipeView:fetch:" << fetch << ":0x" << std::hex << inst.getRIP() << std::dec
+         << ":" << (int)inst.getUopNum() << ":" << inst.getSeqNum() << ":"
+         << *inst.getTransOp() << "\n";
+
+  char lines[256];
+  snprintf(lines, sizeof(lines),
+           "O3PipeView:decode:%llu\n"
+           "O3PipeView:rename:%llu\n"
+           "O3PipeView:dispatch:%llu\n"
+           "O3PipeView:issue:%llu\n"
+           "O3PipeView:complete:%llu\n"
+           "O3PipeView:retire:%llu:store:%llu\n",
+           (unsigned long long)fetch,
+           (unsigned long long)inst.getStageCycle(DECODE_STAGE),
+           (unsigned long long)inst.getStageCycle(WAIT_RA_STAGE),
+           (unsigned long long)inst.getStageCycle(EXECUTE_STAGE),
+           (unsigned long long)inst.getStageCycle(COMPLETE_STAGE),
+           (unsigned long long)retire_cycle, (unsigned long long)store);
+  *m_out << lines;
+}
@@ -0,0 +1,77 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+//===-- PipeTrace.h - O3PipeView pipeline trace -----------------*- C++ -*--=//
+//
+//! PipeTrace writes one record per uop as it leaves the window, retired
+//! or squashed, in gem5's O3PipeView format, which Konata and gem5's
+//! o3-pipeview.py display:
+//!   O3PipeView:fetch:<cycle>:0x<rip>:<uop>:<seq>:<uop text>
+//!   O3PipeView:decode:<cycle>
+//!   O3PipeView:rename:<cycle>
+//!   O3PipeView:dispatch:<cycle>
+//!   O3PipeView:issue:<cycle>
+//!   O3PipeView:complete:<cycle>
+//!   O3PipeView:retire:<cycle>:store:<cycle>
+//! A stage the uop never reached, and the retire of a squashed uop, is 0.
+//! Pyrite decodes in the fetch cycle, so decode repeats fetch.  The
+//! cycles come from DynamicInst::setStage().
+//!
+//! Only uops fetched inside the cycle window, while the committed x86
+//! instruction count is inside the instruction window, are written.  A
+//! file name ending in ".gz" is gzip-compressed.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef __PIPE_TRACE_H
+#define __PIPE_TRACE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "globals.h"
+#include "Event.h"
+
+class DynamicInst;
+
+class PipeTrace {
+public:
+  PipeTrace();
+  ~PipeTrace();
+
+  //! an end of 0 leaves that window open-ended
+  void open(const std::string& filename, bool gzip, Tick start_cycle, Tick end_cycle,
+            W64 start_instruction, W64 end_instruction);
+  void close();
+  bool isOpen() const { return m_out != NULL; }
+
+  //! write the record of a uop leaving the window; retire_cycle is 0 if
+  //! it was squashed.  committed is the processor's committed x86
+  //! instruction count.
+  void record(const DynamicInst &inst, Tick retire_cycle, W64 committed);
+
+private:
+  std::ostream *m_out;
+  std::vector<char> m_buffer;   //!< stream buffer of an uncompressed trace
+  Tick m_start_cycle, m_end_cycle;
+  W64 m_start_instruction, m_end_instruction;
+};
+
+#endif /* __PIPE_TRACE_H */
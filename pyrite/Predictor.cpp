@@ -28,9 +28,18 @@
 #include "DynamicInst.h"
 #include "QPointer.h"
 #include "Predictor.h"
-
-ReturnAddressStack::ReturnAddressStack(int size)
-  : m_speculative_rs(), m_committed_rs(), m_table(size), m_next_top_of_stack(size, -1) {
+#include "TagePredictor.h"
+#include "PerceptronPredictor.h"
+#include "BranchTargetBuffer.h"
+#include "Checkpoint.h"
+#include "params.h"
+
+//! 2-bit saturating counter update, indexed by [taken][counter]
+static const unsigned char s_counter_update[2][4] = {{0, 0, 1, 2}, {1, 2, 3, 3}};
+
+ReturnAddressStack::ReturnAddressStack(int size, unsigned window_size)
+  : m_speculative_rs(), m_committed_rs(), m_inflights(window_size), m_table(size), 
+    m_next_top_of_stack(size, -1) {
 }
 
 void 
@@ -44,13 +53,13 @@ ReturnAddressStack::push(QPointer q_ptr, Waddr return_target_rip) {
   m_speculative_rs.setNextFree(rasIncrement(m_speculative_rs.getNextFree()));
 
   // checkpoint ras pointers
-  m_inflights[q_ptr] = m_speculative_rs;
+  m_inflights.save(q_ptr) = m_speculative_rs;
 }
 
 Waddr 
 ReturnAddressStack::pop(QPointer q_ptr) {
   //! checkpoint ras pointers
-  m_inflights[q_ptr] = m_speculative_rs;
+  m_inflights.save(q_ptr) = m_speculative_rs;
 
   if (m_speculative_rs.getTopOfStack() == -1) { 
     return 0; 
@@ -76,7 +85,7 @@ ReturnAddressStack::pop(QPointer q_ptr) {
   /* next_free -- no change */
 
   // checkpoint ras pointers
-  m_inflights[q_ptr] = m_speculative_rs;
+  m_inflights.save(q_ptr) = m_speculative_rs;
 
   return ret_val;
 }
@@ -84,62 +93,117 @@ ReturnAddressStack::pop(QPointer q_ptr) {
 void 
 ReturnAddressStack::squash(QPointer first_bad) {
   m_inflights.squash(first_bad);
-  m_speculative_rs = (m_inflights.empty()) ? m_committed_rs : m_inflights.rbegin()->second;
+  m_speculative_rs = (m_inflights.empty()) ? m_committed_rs : m_inflights.youngest();
 }
 
 void 
 ReturnAddressStack::commit(QPointer q_ptr) {
-  assert(m_inflights.find(q_ptr) != m_inflights.end());
-  m_committed_rs = m_inflights[q_ptr];
+  m_committed_rs = m_inflights.get(q_ptr);
   m_inflights.commit(q_ptr);
 }
 
+void
+ReturnAddressStack::checkpoint(CheckpointWriter& cp) const {
+  cp.write(m_committed_rs.getNextFree());
+  cp.write(m_committed_rs.getTopOfStack());
+  cp.writeArray(&m_table[0], m_table.size());
+  cp.writeArray(&m_next_top_of_stack[0], m_next_top_of_stack.size());
+}
+
+void
+ReturnAddressStack::restore(CheckpointReader& cp) {
+  int next_free, top_of_stack;
+  cp.read(next_free);
+  cp.read(top_of_stack);
+  m_committed_rs.setNextFree(next_free);
+  m_committed_rs.setTopOfStack(top_of_stack);
+  cp.readArray(&m_table[0], m_table.size());
+  cp.readArray(&m_next_top_of_stack[0], m_next_top_of_stack.size());
+  m_speculative_rs = m_committed_rs;
+  m_inflights.clear();
+}
+
+void
+ReturnAddressStack::warmPush(Waddr return_target_rip) {
+  assert(m_inflights.empty());
+  push(0, return_target_rip);
+  commit(0);
+}
+
+void
+ReturnAddressStack::warmPop() {
+  assert(m_inflights.empty());
+  pop(0);
+  commit(0);
+}
+
 bool
 GsharePredictor::predict(Waddr rip, QPointer q_ptr) {
   int hashed_rip = hash(rip);
   bool pred = (m_table[hashed_rip] >= 2);
   m_history = m_history_mask & ((m_history << 1) + (pred ? 1 : 0));
-  m_inflights[q_ptr] = Record(hashed_rip, m_history);
+  m_inflights.save(q_ptr) = Record(hashed_rip, m_history);
   return pred;
 }
 
 void 
 GsharePredictor::resolve(QPointer q_ptr, bool taken) {
-  assert(m_inflights.find(q_ptr) != m_inflights.end());
-  Record &record = m_inflights[q_ptr];
+  Record &record = m_inflights.get(q_ptr);
   record.second = (record.second & ~0x1) + (taken ? 1 : 0);
 }
 
 void 
 GsharePredictor::squash(QPointer first_bad) {
   m_inflights.squash(first_bad);
-  m_history = (m_inflights.empty()) ? m_committed_history : m_inflights.rbegin()->second.second;
+  m_history = (m_inflights.empty()) ? m_committed_history : m_inflights.youngest().second;
 }
 
 void 
 GsharePredictor::commit(QPointer q_ptr) {
-  const unsigned char update[2][4] = {{0, 0, 1, 2}, {1, 2, 3, 3}};
-  assert(m_inflights.find(q_ptr) != m_inflights.end());
-  Record &record = m_inflights[q_ptr];
+  Record &record = m_inflights.get(q_ptr);
   unsigned char &counter = m_table[record.first];
   assert(counter < 4);
-  counter = update[record.second & 0x1][counter];
+  counter = s_counter_update[record.second & 0x1][counter];
   m_committed_history = record.second;
   m_inflights.commit(q_ptr);
 }
 
+void
+GsharePredictor::checkpoint(CheckpointWriter& cp) const {
+  cp.write(m_history_length);
+  cp.write(uint64(m_committed_history));
+  cp.writeArray(&m_table[0], m_table.size());
+}
+
+void
+GsharePredictor::restore(CheckpointReader& cp) {
+  uint64 history;
+  cp.check(m_history_length, "gshare history length");
+  cp.read(history);
+  cp.readArray(&m_table[0], m_table.size());
+  m_history = m_committed_history = history;
+  m_inflights.clear();
+}
+
+void
+GsharePredictor::warm(Waddr rip, bool taken) {
+  assert(m_inflights.empty());
+  unsigned char &counter = m_table[hash(rip)];
+  counter = s_counter_update[taken ? 1 : 0][counter];
+  m_history = m_committed_history = m_history_mask & ((m_committed_history << 1) + (taken ? 1 : 0));
+}
+
 Waddr 
 SimpleIndirectPredictor::predict(Waddr rip, QPointer q_ptr) {
   int hashed_rip = hash(rip);
   Waddr pred = m_targets[hashed_rip];
-  m_inflights[q_ptr] = Record(hashed_rip, pred);
+  m_inflights.save(q_ptr) = Record(hashed_rip, pred);
   return pred;
 }
 
 void 
 SimpleIndirectPredictor::resolve(QPointer q_ptr, Waddr target) {
-  assert(m_inflights.find(q_ptr) != m_inflights.end());
-  Record &record = m_inflights[q_ptr];
+  Record &record = m_inflights.get(q_ptr);
   if (record.second != target) { //! a mispredict
     record.second = target;
   }
@@ -147,25 +211,65 @@ SimpleIndirectPredictor::resolve(QPointer q_ptr, Waddr target) {
 
 void 
 SimpleIndirectPredictor::commit(QPointer q_ptr) {
-  assert(m_inflights.find(q_ptr) != m_inflights.end());
-  Record &record = m_inflights[q_ptr];
+  Record &record = m_inflights.get(q_ptr);
   m_targets[record.first] = record.second;
   m_inflights.commit(q_ptr);
 }
 
-PredictorSet::PredictorSet() {
+void
+SimpleIndirectPredictor::checkpoint(CheckpointWriter& cp) const {
+  cp.writeArray(&m_targets[0], m_targets.size());
+}
+
+void
+SimpleIndirectPredictor::restore(CheckpointReader& cp) {
+  cp.readArray(&m_targets[0], m_targets.size());
+  m_inflights.clear();
+}
+
+void
+SimpleIndirectPredictor::warm(Waddr rip, Waddr target) {
+  assert(m_inflights.empty());
+  m_targets[hash(rip)] = target;
+}
+
+PredictorSet::PredictorSet(unsigned window_size) {
   /* configure direct branch predictor */
-  unsigned hist_length = 8;
-  unsigned direct_table_bits = 12;
-  m_direct = new GsharePredictor(hist_length, direct_table_bits);
+  m_direct_name = g_params.getDirectPredictor();
+  if (m_direct_name == "gshare") {
+    unsigned hist_length = 8;
+    unsigned direct_table_bits = 12;
+    m_direct = new GsharePredictor(hist_length, direct_table_bits, window_size);
+  } else if (m_direct_name == "not_taken") {
+    m_direct = new NotTakenPredictor();
+  } else if (m_direct_name == "perceptron") {
+    m_direct = new PerceptronPredictor(window_size);
+  } else if (m_direct_name == "tage_sc_l") {
+    m_direct = new TageScLPredictor(window_size);
+  } else {
+    ERROR_MSG("Unknown directPredictor: " + m_direct_name);
+  }
 
   /* configure indirect branch predictor */
-  int indirect_table_bits = 8;
-  m_indirect = new SimpleIndirectPredictor(indirect_table_bits);
+  m_indirect_name = g_params.getIndirectPredictor();
+  if (m_indirect_name == "simple") {
+    int indirect_table_bits = 8;
+    m_indirect = new SimpleIndirectPredictor(indirect_table_bits, window_size);
+  } else if (m_indirect_name == "ittage") {
+    m_indirect = new IttagePredictor(window_size);
+  } else {
+    ERROR_MSG("Unknown indirectPredictor: " + m_indirect_name);
+  }
 
   /* configure ras */
   int ras_size = 32;
-  m_ras = new ReturnAddressStack(ras_size);
+  m_ras = new ReturnAddressStack(ras_size, window_size);
+
+  /* configure btb */
+  m_btb = NULL;
+  if (g_params.getBtbEntries() > 0) {
+    m_btb = new BranchTargetBuffer(g_params.getBtbEntries(), g_params.getBtbAssoc());
+  }
 
   /* init data recording stuff */
   for (int i = 0 ; i < (int) PTYPE_MAX ; i ++) { 
@@ -175,8 +279,11 @@ PredictorSet::PredictorSet() {
 
 PredType
 PredictorSet::getPredType(DynamicInst *inst) {
-  int opcode = inst->getOpcode();
-  int extshift = inst->getTransOp()->extshift;
+  return getPredType(inst->getOpcode(), inst->getTransOp()->extshift);
+}
+
+PredType
+PredictorSet::getPredType(int opcode, int extshift) {
   assert(isbranch(opcode));
 
   if(isclass(opcode, OPCLASS_COND_BRANCH)) {
@@ -191,7 +298,7 @@ PredictorSet::getPredType(DynamicInst *inst) {
 }
 
 Waddr
-PredictorSet::predict(DynamicInst *inst, Waddr fallthrough) {
+PredictorSet::predict(DynamicInst *inst, Waddr fallthrough, bool &btb_miss) {
   Waddr branch_rip = inst->getRIP();
   const TransOp *trans_op = inst->getTransOp();
   int opcode = inst->getOpcode();
@@ -223,6 +330,12 @@ PredictorSet::predict(DynamicInst *inst, Waddr fallthrough) {
     m_ras->push(inst->getQPointer(), fallthrough);
   }
 
+  // a branch fetch thinks is not there can only fall through
+  btb_miss = false;
+  if (m_btb && ((pred_type != PTYPE_COND) || (pred_target != fallthrough))) {
+    btb_miss = !m_btb->lookup(branch_rip);
+  }
+
   inst->setPredTarget(pred_target);
   return pred_target;
 }
@@ -233,11 +346,14 @@ PredictorSet::resolve(DynamicInst *inst, Waddr actual_target) {
   PredType pred_type = getPredType(inst);
   
   switch(pred_type) {
-    case PTYPE_COND: {
-      bool taken = actual_target != trans_op->ripseq;
-      m_direct->resolve(inst->getQPointer(), taken);
+    case PTYPE_COND:
+      // only a mispredict, which squashes everything younger, may change
+      // the direction already in the history; when riptaken == ripseq
+      // both directions are correct and the predicted one stands
+      if (inst->isMispredicted()) {
+        m_direct->resolve(inst->getQPointer(), actual_target != trans_op->ripseq);
+      }
       break;
-    }
     case PTYPE_INDIRECT:
       m_indirect->resolve(inst->getQPointer(), actual_target);
       break;
@@ -283,8 +399,50 @@ PredictorSet::commit(DynamicInst *inst) {
   if(trans_op->extshift == BRANCH_HINT_PUSH_RAS) {
     m_ras->commit(inst->getQPointer());
   }
+
+  // trained at commit so wrong-path branches do not allocate or evict;
+  // a conditional branch was taken if predicted taken and right, or
+  // predicted not taken and wrong
+  if (m_btb) {
+    bool pred_taken = (inst->getPredTarget() != trans_op->ripseq);
+    if ((pred_type != PTYPE_COND) || (pred_taken != inst->isMispredicted())) {
+      m_btb->insert(branch_rip);
+    }
+  }
 }
   
+void
+PredictorSet::warm(Waddr rip, PredType type, bool push_ras, Waddr fallthrough, Waddr actual_target) {
+  switch(type) {
+    case PTYPE_COND:
+      m_direct->warm(rip, actual_target != fallthrough);
+      break;
+    case PTYPE_INDIRECT:
+      m_indirect->warm(rip, actual_target);
+      break;
+    case PTYPE_RAS:
+      m_ras->warmPop();
+      break;
+    default:
+      // do nothing
+      break;
+  }
+
+  if (push_ras) {
+    m_ras->warmPush(fallthrough);
+  }
+
+  if (m_btb && (actual_target != fallthrough)) {
+    m_btb->insert(rip);
+  }
+}
+  
+//! 1.0 rather than nan when nothing was predicted
+static double
+accuracy(W64 misses, W64 total) {
+  return (total == 0) ? 1.0 : 1.0 - (double) misses / (double) total;
+}
+
 void 
 PredictorSet::printAccuracies(FILE *file) {
   const char *branch_types[] = {"PTYPE_COND    ",
@@ -292,16 +450,55 @@ PredictorSet::printAccuracies(FILE *file) {
                                 "PTYPE_RAS     ",
                                 "PTYPE_NONE    "};
   fprintf(file, "\n");
+  fprintf(file, "Direct predictor: %s, indirect predictor: %s\n", 
+          m_direct_name.c_str(), m_indirect_name.c_str());
   W64 total_misp = 0, total_branches = 0;
   for (int i = 0 ; i < (int) PTYPE_MAX ; i ++) { 
     fprintf(file, "%s: %d\t%d\t%f\n", branch_types[i], (int)m_mispredictions[i], 
-            (int)m_branches[i], 1.0 - (float)m_mispredictions[i]/(float)m_branches[i]);
+            (int)m_branches[i], accuracy(m_mispredictions[i], m_branches[i]));
     total_misp += m_mispredictions[i];
     total_branches += m_branches[i];
   }
   total_branches -= m_branches[PTYPE_NONE]; /* these aren't really predictions */
   fprintf(file, "All Predictions %d\t%d\t%f\n", (int)total_misp, 
-          (int)total_branches, 1.0 - (float)total_misp/(float)total_branches);
+          (int)total_branches, accuracy(total_misp, total_branches));
+  if (m_btb) {
+    // misses among the lookups of predicted-taken branches
+    fprintf(file, "BTB           : %d\t%d\t%f\n", (int)m_btb->getMisses(), 
+            (int)m_btb->getLookups(), accuracy(m_btb->getMisses(), m_btb->getLookups()));
+  }
+}
+
+void
+PredictorSet::checkpoint(CheckpointWriter& cp) const {
+  cp.beginSection("predictors");
+  cp.write(m_direct_name);
+  cp.write(m_indirect_name);
+  m_direct->checkpoint(cp);
+  m_indirect->checkpoint(cp);
+  m_ras->checkpoint(cp);
+  cp.write(m_btb != NULL);
+  if (m_btb) {
+    m_btb->checkpoint(cp);
+  }
+}
+
+void
+PredictorSet::restore(CheckpointReader& cp) {
+  cp.beginSection("predictors");
+  cp.check(m_direct_name, "direct predictor");
+  cp.check(m_indirect_name, "indirect predictor");
+  m_direct->restore(cp);
+  m_indirect->restore(cp);
+  m_ras->restore(cp);
+  bool has_btb;
+  cp.read(has_btb);
+  if (has_btb != (m_btb != NULL)) {
+    ERROR_MSG("Checkpoint BTB configuration does not match btbEntries");
+  }
+  if (m_btb) {
+    m_btb->restore(cp);
+  }
 }
 
 void 
@@ -310,4 +507,7 @@ PredictorSet::clearStats() {
     m_branches[i] = 0;
     m_mispredictions[i] = 0;
   }  
+  if (m_btb) {
+    m_btb->clearStats();
+  }
 }
@@ -28,50 +28,142 @@
 #ifndef __PREDICTOR_H
 #define __PREDICTOR_H
 
-#include <map>
 #include <vector>
+#include <string>
 #include "QPointer.h"
 #include "globals.h"
 
+class CheckpointWriter;
+class CheckpointReader;
+
 enum PredType {PTYPE_COND, PTYPE_INDIRECT, PTYPE_RAS, PTYPE_NONE, PTYPE_MAX};
 
 template <class Type>
 class Predictor {
 public:
   virtual Type predict(Waddr PC, QPointer q) = 0;
+  //! record the actual outcome of q, to train on at commit.  Younger
+  //! branches stay in flight: the flush that follows a mispredict
+  //! squashes them and repairs the history.
   virtual void resolve(QPointer q, Type result) = 0;
   virtual void commit(QPointer q) = 0;
   virtual void squash(QPointer first_bad) = 0;
+
+  //! save and restore the committed (non-speculative) state; a
+  //! restored predictor has no branches in flight
+  virtual void checkpoint(CheckpointWriter& cp) const {}
+  virtual void restore(CheckpointReader& cp) {}
+
+  //! train the committed state with an already resolved branch, as
+  //! functional warming does; only legal with no branches in flight
+  virtual void warm(Waddr PC, Type result) {}
 };
 
 typedef Predictor<bool> DirectPredictor;
 typedef Predictor<Waddr> IndirectPredictor;
 
+//! the speculative state of the branches in flight: one checkpoint
+//! per instruction window slot, indexed by QPointer.  Branches are
+//! saved in program order, committed oldest first and squashed
+//! youngest first, so the live checkpoints form a chain from the
+//! youngest back to the oldest and every operation is O(1) (squash
+//! amortized over the saves it undoes).
 template <class Type>
-class SquashableMap : public std::map<QPointer, Type> {
-  typedef std::map<QPointer, Type> super;
+class SquashableRing {
 public:
-  typedef typename std::map<QPointer, Type>::iterator iterator;
+  SquashableRing(unsigned window_size) 
+    : m_entries(window_size), m_oldest(0), m_youngest(0), m_count(0) {
+    assert((window_size & (window_size - 1)) == 0);
+  }
+
+  bool empty() const { return m_count == 0; }
+  unsigned size() const { return m_count; }
+  bool contains(QPointer q_ptr) const {
+    const Entry &e = m_entries[slot(q_ptr)];
+    return e.m_live && (e.m_q_ptr == q_ptr);
+  }
+
+  //! the checkpoint of branch q_ptr, which must be the youngest in
+  //! flight (or younger, in which case a new checkpoint is started)
+  Type &save(QPointer q_ptr) {
+    Entry &e = m_entries[slot(q_ptr)];
+    if (empty() || (q_ptr != m_youngest)) {
+      assert(empty() || (q_ptr > m_youngest));
+      assert(!e.m_live);
+      e.m_live = true;
+      e.m_q_ptr = q_ptr;
+      e.m_prev = m_youngest;
+      if (empty()) {
+        m_oldest = q_ptr;
+      } else {
+        m_entries[slot(m_youngest)].m_next = q_ptr;
+      }
+      m_youngest = q_ptr;
+      ++ m_count;
+    }
+    return e.m_value;
+  }
+  Type &get(QPointer q_ptr) {
+    assert(contains(q_ptr));
+    return m_entries[slot(q_ptr)].m_value;
+  }
+  const Type &youngest() const {
+    assert(!empty());
+    return m_entries[slot(m_youngest)].m_value;
+  }
+  QPointer youngestQPointer() const {
+    assert(!empty());
+    return m_youngest;
+  }
+
   void squash(QPointer first_bad) {
-    iterator i = super::lower_bound(first_bad); 
-    for (iterator j = i ; j != super::end() ; j++) {
-      assert(j->first >= first_bad);
+    while (!empty() && (m_youngest >= first_bad)) {
+      Entry &e = m_entries[slot(m_youngest)];
+      e.m_live = false;
+      m_youngest = e.m_prev;
+      -- m_count;
     }
-    super::erase(i, super::end());
   }
+  //! only the oldest branch in flight commits
   void commit(QPointer q_ptr) {
-    assert((q_ptr == 0) || (super::upper_bound(q_ptr - 1) == super::begin()));
-    super::erase(q_ptr);
+    assert(contains(q_ptr) && (q_ptr == m_oldest));
+    Entry &e = m_entries[slot(q_ptr)];
+    e.m_live = false;
+    m_oldest = e.m_next;
+    -- m_count;
   }
+  void clear() {
+    squash(0);
+  }
+
+private:
+  struct Entry {
+    Entry() : m_live(false), m_q_ptr(0), m_prev(0), m_next(0), m_value() {}
+    bool m_live;
+    QPointer m_q_ptr;
+    QPointer m_prev;            // the next older branch in flight
+    QPointer m_next;            // the next younger one, if any
+    Type m_value;
+  };
+  unsigned slot(QPointer q_ptr) const { return q_ptr & (m_entries.size() - 1); }
+
+  std::vector<Entry> m_entries;
+  QPointer m_oldest;
+  QPointer m_youngest;
+  unsigned m_count;
 };
 
 class ReturnAddressStack {
 public:
-  ReturnAddressStack(int size);
+  ReturnAddressStack(int size, unsigned window_size);
   void push(QPointer q, Waddr return_target_rip);
   Waddr pop(QPointer q);  
   void squash(QPointer first_bad);
   void commit(QPointer q);
+  void checkpoint(CheckpointWriter& cp) const;
+  void restore(CheckpointReader& cp);
+  void warmPush(Waddr return_target_rip);
+  void warmPop();
 
 private:
   int rasIncrement(int index) const { return (index + 1) & (m_table.size() - 1); }
@@ -98,7 +190,7 @@ private:
     int m_next_free, m_top_of_stack;
   };
   RasState m_speculative_rs, m_committed_rs;
-  SquashableMap<RasState> m_inflights;
+  SquashableRing<RasState> m_inflights;
   std::vector<Waddr> m_table;
   std::vector<int> m_next_top_of_stack;
 };
@@ -116,15 +208,18 @@ public:
 class GsharePredictor : public DirectPredictor {
 public:
   typedef std::pair<int, unsigned> Record;
-  GsharePredictor(unsigned history_length, unsigned table_bits) :
+  GsharePredictor(unsigned history_length, unsigned table_bits, unsigned window_size) :
     m_history_length(history_length), m_num_bits(table_bits), m_table_size(1 << table_bits), 
-    m_history_mask((1 << history_length) - 1), m_table(m_table_size, 1) {
+    m_history_mask((1 << history_length) - 1), m_inflights(window_size), m_table(m_table_size, 1) {
     m_history = m_committed_history = 0;
   }
   bool predict(Waddr rip, QPointer q_ptr);
   void resolve(QPointer q_ptr, bool taken);
   void squash(QPointer first_bad);
   void commit(QPointer q_ptr);
+  void checkpoint(CheckpointWriter& cp) const;
+  void restore(CheckpointReader& cp);
+  void warm(Waddr rip, bool taken);
 
 private:
   unsigned hash(Waddr rip) const { 
@@ -135,7 +230,7 @@ private:
   }
   const int m_history_length, m_num_bits, m_table_size, m_history_mask;
   unsigned m_history, m_committed_history;
-  SquashableMap<Record> m_inflights;
+  SquashableRing<Record> m_inflights;
   std::vector<unsigned char> m_table;
 };
 
@@ -143,45 +238,65 @@ private:
 class SimpleIndirectPredictor : public IndirectPredictor {
 public:
   typedef std::pair<int, Waddr> Record;
-  SimpleIndirectPredictor(int num_bits) : 
-    m_num_bits(num_bits), m_table_size(1 << num_bits), m_targets(m_table_size, 0) {}
+  SimpleIndirectPredictor(int num_bits, unsigned window_size) : 
+    m_num_bits(num_bits), m_table_size(1 << num_bits), m_inflights(window_size), m_targets(m_table_size, 0) {}
 
   Waddr predict(Waddr rip, QPointer q_ptr);
   void resolve(QPointer q_ptr, Waddr target);
   void squash(QPointer first_bad) { m_inflights.squash(first_bad); }
   void commit(QPointer q_ptr);
+  void checkpoint(CheckpointWriter& cp) const;
+  void restore(CheckpointReader& cp);
+  void warm(Waddr rip, Waddr target);
 
 private:
   int hash(Waddr rip) const { 
     return (int) ((rip >> (m_num_bits + 2)) ^ (rip >> 2)) & (m_table_size - 1); 
   }
   const int m_num_bits, m_table_size;
-  SquashableMap<Record> m_inflights;
+  SquashableRing<Record> m_inflights;
   std::vector<Waddr> m_targets;
 };
 
 class DynamicInst;
+class BranchTargetBuffer;
 
 //! this class manages a collection of predictors, determining what
 //! should be done to each for various operations on different types of
 //! branches.
 class PredictorSet {
 public:
-  PredictorSet();
+  //! the predictors and BTB chosen in params.def, with room for a
+  //! checkpoint per window slot
+  PredictorSet(unsigned window_size);
   PredictorSet(DirectPredictor *direct, IndirectPredictor *indirect, 
-               ReturnAddressStack *ras) : m_direct(direct), m_indirect(indirect), m_ras(ras) {
+               ReturnAddressStack *ras, BranchTargetBuffer *btb = NULL) 
+    : m_direct(direct), m_indirect(indirect), m_ras(ras), m_btb(btb),
+      m_direct_name("custom"), m_indirect_name("custom") {
     for (int i = 0 ; i < (int) PTYPE_MAX ; i++) { 
       m_branches[i] = m_mispredictions[i] = 0;
     }
   }
 
-  Waddr predict(DynamicInst *inst, Waddr fallthrough);
+  //! btb_miss is set if the branch is predicted taken but the BTB did
+  //! not know it, so fetch only learns of it at decode
+  Waddr predict(DynamicInst *inst, Waddr fallthrough, bool &btb_miss);
   void resolve(DynamicInst *inst, Waddr actual_addr);
   void squash(QPointer first_bad);
   void commit(DynamicInst *inst);
 
   void printAccuracies(FILE *file);
   void clearStats();
+
+  //! save and restore the predictor tables (see Checkpoint.h)
+  void checkpoint(CheckpointWriter& cp) const;
+  void restore(CheckpointReader& cp);
+
+  //! functional warming: train the predictors with a branch that
+  //! Simics has already executed.  Not counted in the accuracies.
+  void warm(Waddr rip, PredType type, bool push_ras, Waddr fallthrough, Waddr actual_target);
+
+  static PredType getPredType(int opcode, int extshift);
   
 private:
   PredType getPredType(DynamicInst *inst);
@@ -189,6 +304,8 @@ private:
   DirectPredictor *m_direct;
   IndirectPredictor *m_indirect;
   ReturnAddressStack *m_ras;
+  BranchTargetBuffer *m_btb;    // NULL for a perfect BTB
+  std::string m_direct_name, m_indirect_name;
 
   W64 m_branches[PTYPE_MAX];
   W64 m_mispredictions[PTYPE_MAX];
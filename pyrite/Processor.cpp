@@ -46,6 +46,9 @@
 #include "RubyMemoryInterface.h"
 #include "SimpleMemoryInterface.h"
 #include "DynamicInst.h"
+#include "Checkpoint.h"
+#include "HostProfiler.h"
+#include "HostMemory.h"
 
 #define PAGE_BYTES 4096
 #define PAGE_OFFSET(x) ((x) & (PAGE_BYTES - 1))
@@ -54,6 +57,29 @@ Vector<Processor*> g_processors_vec;
 EventLog g_eventLog; // accessed via the LOG_EVENT macro
 
 Map<Waddr, string> g_code_map;
+//! heap bytes of the strings in g_code_map, added up as they are
+//! inserted so that a sample does not walk the map
+static int64 s_code_map_string_bytes = 0;
+
+//! Reports the disassembly strings kept in g_code_map for the disasm file
+class CodeMapReporter : public HostMemoryReporter {
+public:
+  void reportHostMemory() const {
+    HostMemory::report(HOST_MEMORY_CODE_MAP, g_code_map.getMemoryUsage() + s_code_map_string_bytes);
+  }
+};
+static CodeMapReporter s_code_map_reporter;
+
+//! the heap buffer of str; 0 for a short string kept inside the
+//! string object, which the map's own usage already covers
+static int64
+stringHeapBytes(const string &str) {
+  const char *object = (const char *) &str;
+  if ((str.data() >= object) && (str.data() < object + sizeof(str))) {
+    return 0;
+  }
+  return str.capacity() + 1;
+}
 
 unsigned g_x86_fetch_width = 0;
 unsigned g_rename_width = 0;
@@ -120,11 +146,18 @@ void interrupt_callback(void* callback_data,
 
 Processor::Processor(int processor_number)
   : Context(), m_physical_file(), m_front_end_map(m_physical_file),
-    m_retire_map(m_physical_file), fetch_pipe(), core_pipe(), retire_pipe(),
-    m_predictors(), record_handler(0), record_factory(0) {
-  // m_buf_size must be a power of 2 (otherwise mappedIndex() will not work properly)
-  m_buf_size = 1 << 7; /* 128 uop instruction window */
+    m_retire_map(m_physical_file), 
+    // m_buf_size must be a power of 2 (otherwise mappedIndex() will not work properly)
+    m_buf_size(1 << 7), /* 128 uop instruction window */
+    fetch_pipe(), core_pipe(), retire_pipe(),
+    m_predictors(m_buf_size), record_handler(0), record_factory(0) {
   m_inst_buffer = new DynamicInst[m_buf_size];
+  m_inst_memory = new DynamicInstMemory[m_buf_size];
+  m_inst_cold = new DynamicInstCold[m_buf_size];
+  for (unsigned i = 0; i < m_buf_size; i++) {
+    m_inst_buffer[i].attach(&m_inst_memory[i], &m_inst_cold[i]);
+  }
+  m_physical_file.init(this, g_params.getPhysicalRegisters(), m_buf_size);
 
   m_processor_number = processor_number;
   m_cpu = SIM_get_processor(m_processor_number);
@@ -215,6 +248,25 @@ Processor::Processor(int processor_number)
   m_crack_unaligned_memops = false;
   m_committing = false;
   m_reset_while_committing = false;
+  m_cpi_recovery = CPI_BASE;
+  m_cpi_recovery_q = 0;
+  m_fetch_resume_cycle = 0;
+  m_seq_num = 0;
+  resetWarming();
+
+  if (strcmp(g_params.getPipeTraceFilePath().c_str(), "/dev/null") != 0) {
+    string pipeTraceFilePath = g_params.getPipeTraceFilePath();
+    bool gzip = (pipeTraceFilePath.size() > 3) &&
+      (pipeTraceFilePath.compare(pipeTraceFilePath.size() - 3, 3, ".gz") == 0);
+    if (SIM_number_processors() > 1) {
+      ostringstream temp;
+      temp << pipeTraceFilePath << "." << m_processor_number;
+      pipeTraceFilePath = temp.str();
+    }
+    m_pipe_trace.open(pipeTraceFilePath, gzip,
+                      g_params.getPipeTraceStartCycle(), g_params.getPipeTraceEndCycle(),
+                      g_params.getPipeTraceStartInstruction(), g_params.getPipeTraceEndInstruction());
+  }
 
   m_scheduler = new OutorderScheduler(this, m_mem_interface);
 }
@@ -358,6 +410,7 @@ W64 Processor::readSimicsRegisterByName(const char *reg_name){
 }
 
 void Processor::stepSimicsCycles(int num_cycles){
+  HOST_PROFILE_SCOPE(HOST_PROFILE_SIMICS);
   assert(SIM_processor_enabled(m_cpu));
   CHECK_SIM_EXCEPTION();
   g_stats.setTotalX86Instructions(m_processor_number, g_stats.getTotalX86Instructions(m_processor_number) + 
@@ -693,6 +746,7 @@ void Processor::initializeProcessorState(void){
 }
 
 bool Processor::fetchMoreBytes(Waddr &fetch_address, W8 *fetch_buffer, unsigned &num_bytes) {
+  HOST_PROFILE_SCOPE(HOST_PROFILE_SIMICS);
   W64 phys_addr;
   // printf("A: %d(%x) NB: %d\n", (int)fetch_address, (int)fetch_address, num_bytes);
 
@@ -728,6 +782,7 @@ bool Processor::decodeCurrentX86Instruction(bool &taken_branch){
     }
 
     try{
+      HOST_PROFILE_SCOPE(HOST_PROFILE_DECODE);
       // prime decoder
       m_decoder->reset();
       m_decoder->use64 = m_is64bit;
@@ -742,6 +797,7 @@ bool Processor::decodeCurrentX86Instruction(bool &taken_branch){
     } catch (NotEnoughBytesException& e) {
       // still not enough bytes--back to top of loop
       assert(num_bytes <= 24);
+      g_stats.incrementDecodeRefetches(m_processor_number);
       continue;
     } catch (InvalidOpcodeException& e) {
       logInvalidOpcodeEvent(e);
@@ -775,6 +831,8 @@ bool Processor::decodeCurrentX86Instruction(bool &taken_branch){
       irecord->SetUopNum(i);
       dyn_curr->setRecord(irecord); 
     }
+    dyn_curr->setUopNum(i);
+    dyn_curr->setSeqNum(m_seq_num++);
     dyn_curr->setStage(FETCH_STAGE);
     if (m_crack_unaligned_memops &&
         ((isload(curr.opcode)  && (curr.ra != REG_ctx)) ||
@@ -797,10 +855,16 @@ bool Processor::decodeCurrentX86Instruction(bool &taken_branch){
             (last_inst->getTransOp()->extshift != BRANCH_HINT_PUSH_RAS)) ||
            (isindirectbranch(last_inst->getOpcode())) ||
            ((insn_address + instruction_size) == last_inst->getTransOp()->ripseq));
-    m_fetch_rip = m_predictors.predict(last_inst, last_inst->getTransOp()->ripseq);
+    bool btb_miss;
+    m_fetch_rip = m_predictors.predict(last_inst, last_inst->getTransOp()->ripseq, btb_miss);
     if (m_fetch_rip != (insn_address + instruction_size)) {
       taken_branch = true;
     }
+    if (btb_miss) {
+      // the target is not known until the branch reaches decode
+      g_stats.incrementBtbMisses(m_processor_number);
+      m_fetch_resume_cycle = getCurrentCycle() + 1 + g_params.getBtbMissPenalty();
+    }
     // printf("uop: %d, predicted 0x%x, sequential 0x%x\n", (int)last_inst->getQPointer(),
     //        (int)m_fetch_rip, (int)(insn_address + instruction_size));
   } else {
@@ -814,6 +878,55 @@ bool Processor::decodeCurrentX86Instruction(bool &taken_branch){
   return true;
 }
 
+// Decode just enough of the instruction at rip to train the branch
+// predictors.  Anything that does not decode is treated as a non-branch.
+void Processor::decodeForWarming(Waddr rip, WarmInsn &insn){
+  W8 fetch_buffer[32];
+  unsigned num_bytes = 0;
+  Waddr fetch_address = rip;
+  TransOp trans_op_buf[MAX_TRANSOPS_PER_USER_INSN];
+
+  insn.m_size = 0;
+  insn.m_type = PTYPE_MAX;
+  insn.m_push_ras = false;
+
+  while(1) {
+    if (!fetchMoreBytes(fetch_address, fetch_buffer, num_bytes)) {
+      return;
+    }
+
+    try{
+      m_decoder->reset();
+      m_decoder->use64 = m_is64bit;
+      m_decoder->rip = rip;
+      m_decoder->ripstart = rip;
+      m_decoder->split_basic_block_at_locks_and_fences = false;
+      m_decoder->split_invalid_basic_blocks = false;
+      m_decoder->split_unaligned_memops = false;
+
+      insn.m_size = m_decoder->translate(fetch_buffer, num_bytes, trans_op_buf);
+      break;
+    } catch (NotEnoughBytesException& e) {
+      assert(num_bytes <= 24);
+      continue;
+    } catch (InvalidOpcodeException& e) {
+      return;
+    } catch (UnimplementedOpcodeException& e){
+      return;
+    }
+  }
+
+  unsigned num_uops = m_decoder->transbufcount;
+  if (num_uops == 0) {
+    return;
+  }
+  const TransOp &last = trans_op_buf[num_uops - 1];
+  if (isbranch(last.opcode)) {
+    insn.m_type = PredictorSet::getPredType(last.opcode, last.extshift);
+    insn.m_push_ras = (last.extshift == BRANCH_HINT_PUSH_RAS);
+  }
+}
+
 void Processor::logInvalidOpcodeEvent(InvalidOpcodeException& e){
   LOG_EVENT(DEBUG_INVALID_OPCODE, Box<TransOp>(), e.what());
   g_stats.incrementInvalidX86Instructions(m_processor_number);
@@ -859,6 +972,7 @@ void Processor::logInstructionDecodeEvent(W64 insn_address, unsigned instruction
         sbuf << "   " << i << ": " << *getDynamicInst(q_ptr + i)->getTransOp() << "\n";
       }
       g_code_map.insert(insn_address, sbuf.str());
+      s_code_map_string_bytes += stringHeapBytes(g_code_map.lookup(insn_address));
     }
   }
 
@@ -879,6 +993,7 @@ void Processor::logInstructionDecodeEvent(W64 insn_address, unsigned instruction
 }
 
 void Processor::rename(void){
+  HOST_PROFILE_SCOPE(HOST_PROFILE_RENAME);
   QPointer q_rename_ready = fetch_pipe.readHead();
 
   // Don't try to rename past the end of the ROB
@@ -904,6 +1019,10 @@ void Processor::rename(void){
       dyn_curr->completeAtDecode();
       --i; 
     } else {
+      if (dyn_curr->allocatesRegister() && !m_physical_file.hasFree()) {
+        g_stats.incrementRenameRegisterStalls(m_processor_number);
+        break;
+      }
       dyn_curr->rename();
     }
     ++m_q_rename;
@@ -925,12 +1044,16 @@ void Processor::resolveBranch(QPointer q, Waddr actual_target) {
   if ((q + 1) < m_q_head) {  // if successor has already been fetched
     if(dyn_curr->isMispredicted()) {
       flushPipeline(q + 1);
+      startCpiRecovery(CPI_FRONTEND_MISPREDICT, q + 1);
       m_fetch_rip = actual_target;  // re-direct fetch to correct target
     } else {
       // correctly predicted branch
     }
   } else {
     m_fetch_rip = actual_target;  // successor hasn't been fetched, write to front end PC
+    if (dyn_curr->isMispredicted()) {
+      m_predictors.squash(q + 1);  // nothing to flush, but repair the predictor history
+    }
     if (m_q_oldest_bad == m_q_head) {
       m_q_oldest_bad  = (QPointer)-1;  // this was marked "bad" because we didn't know what it was
     }
@@ -952,6 +1075,7 @@ void Processor::checkException(QPointer q) {
 
   // flush everything after this uop
   flushPipeline(q + 1);
+  startCpiRecovery(CPI_FRONTEND_REFETCH, q + 1);
 
   // fixup the x86 op meta data so that this op is the last member
   dyn_curr->setEndsX86Op();
@@ -971,9 +1095,14 @@ void Processor::alignmentException(QPointer q) {
   // flush this entire x86 op, and refetch it (but crack it next time)
   m_fetch_rip = dyn_first->getRIP();
   flushPipeline(dyn_first->getQPointer());
+  startCpiRecovery(CPI_FRONTEND_REFETCH, dyn_first->getQPointer());
   m_crack_unaligned_memops = true;
 }
 
+void Processor::wakeupSlot(unsigned slot) {
+  m_inst_buffer[slot].wakeup();
+}
+
 void Processor::wakeup(DynamicInst *d) {
   if (m_scheduler != NULL) { 
     m_scheduler->wakeup(d);
@@ -981,6 +1110,7 @@ void Processor::wakeup(DynamicInst *d) {
 }
 
 void Processor::execute(void){
+  HOST_PROFILE_SCOPE(HOST_PROFILE_EXECUTE);
   for (int i = 0 ; i < g_execute_width ; ++ i) {
     QPointer q_execute_ready = core_pipe.readHead();
     if (m_q_execute >= q_execute_ready) {
@@ -1005,6 +1135,7 @@ void Processor::execute(void){
 }
 
 void Processor::flushPipeline(QPointer q_first_bad) {
+  m_fetch_resume_cycle = 0;  // the redirect supersedes any BTB miss
   fetch_pipe.squash(q_first_bad);
   m_predictors.squash(q_first_bad);
   core_pipe.squash(q_first_bad);
@@ -1044,6 +1175,7 @@ void Processor::replay(QPointer q_first_replayed) {
       record->Free();
     }
     dyn_curr->squash();
+    dyn_curr->setSeqNum(m_seq_num++);
     dyn_curr->setStage(FETCH_STAGE);
     if (record_factory) {
       real_inst_record_t *irecord = record_factory->Allocate();
@@ -1053,15 +1185,61 @@ void Processor::replay(QPointer q_first_replayed) {
     }
   }
   m_q_rename = q_first_replayed;
+  startCpiRecovery(CPI_REPLAY, q_first_replayed);
+}
+
+void Processor::startCpiRecovery(CpiComponent reason, QPointer q_first_refetched) {
+  m_cpi_recovery = reason;
+  m_cpi_recovery_q = q_first_refetched;
+}
+
+// Charge this cycle to one component of the CPI stack (see CpiStack.h),
+// going by why the oldest uop did not retire.  Cycles spent on a miss
+// are kept in the uop until the fill says where the line came from.
+void Processor::accountRetireCycle(int num_retired) {
+  CpiComponent component;
+  if (num_retired > 0) {
+    component = CPI_BASE;
+    if (m_q_retire > m_cpi_recovery_q) {
+      m_cpi_recovery = CPI_BASE;
+    }
+  } else if ((m_cpi_recovery == CPI_REPLAY) && (m_q_retire >= m_cpi_recovery_q)) {
+    component = CPI_REPLAY;
+  } else if (m_q_retire >= m_q_execute) {
+    // the oldest uop is still in the front end
+    bool recovering = (m_cpi_recovery != CPI_BASE) && (m_q_retire >= m_cpi_recovery_q);
+    component = recovering ? m_cpi_recovery : CPI_FRONTEND_BUBBLE;
+  } else {
+    DynamicInst *dyn_oldest = getDynamicInst(m_q_retire);
+    if (dyn_oldest->isMissOutstanding()) {
+      dyn_oldest->addMissStallCycle();
+      return;
+    } else if (dyn_oldest->isStoreBlocked()) {
+      component = CPI_STORE_FORWARD;
+    } else if (isload(dyn_oldest->getOpcode()) && dyn_oldest->isExecuted() &&
+               !dyn_oldest->isMemoryIssued()) {
+      component = CPI_MEMORY_L1;  // in the load pipeline
+    } else if (dyn_oldest->isExecuteReady()) {
+      component = (dyn_oldest->isMemoryInst() && !cacheReady()) ? CPI_LSQ_FULL : CPI_SCHEDULER_FULL;
+    } else if (m_q_rename >= (m_q_tail + g_rob_size)) {
+      component = CPI_ROB_FULL;
+    } else {
+      component = CPI_EXECUTE;
+    }
+  }
+  CpiStack::charge(m_processor_number, component);
 }
 
 void Processor::retire() {
+  HOST_PROFILE_SCOPE(HOST_PROFILE_RETIRE);
   QPointer q_retire_ready = retire_pipe.readHead();
+  int num_retired = 0;
   for (int i = 0 ; i < g_retire_width ; ++ i) {
     if (m_q_oldest_bad == m_q_retire) { // for bad fetches/decodes/executions
       resetUopBuf();
       stepSimicsCycles(1);
       resetPyriteState();
+      startCpiRecovery(CPI_FRONTEND_REFETCH, m_q_tail);
       break;
     }
 	 
@@ -1107,6 +1285,7 @@ void Processor::retire() {
       }
       m_fetch_rip = dyn_first->getRIP();
       flushPipeline(dyn_first->getQPointer());
+      startCpiRecovery(CPI_FRONTEND_REFETCH, dyn_first->getQPointer());
       break;
     }
 
@@ -1136,9 +1315,7 @@ void Processor::retire() {
       for (QPointer q = m_q_tail; q <= dyn_curr->getQPointer(); ++ q) {
         DynamicInst *dyn_iter = getDynamicInst(q);
         dyn_iter->commit();
-        if (!dyn_iter->getTransOp()->nouserflags) {
-          flagmask |= setflags_to_x86_flags[dyn_iter->getTransOp()->setflags];
-        }
+        flagmask |= dyn_iter->getUserFlags();
       }
 
       m_committing = true;
@@ -1167,6 +1344,7 @@ void Processor::retire() {
         logIncorrectExecutionEvent(dyn_curr->getRIP());
         resetUopBuf();
         resetPyriteState();
+        startCpiRecovery(CPI_REPLAY, m_q_tail);
         break;
       } else {
         g_stats.incrementCorrectlyExecutedX86Instructions(m_processor_number);
@@ -1175,6 +1353,10 @@ void Processor::retire() {
           if (record_handler != NULL) {
             record_handler->Process(dyn_iter->getRecord(), q);
           }
+          if (m_pipe_trace.isOpen()) {
+            m_pipe_trace.record(*dyn_iter, getCurrentCycle(),
+                                g_stats.getCorrectlyExecutedX86Instructions(m_processor_number));
+          }
         }
         m_q_tail = dyn_curr->getQPointer() + 1;
         sim_cycle = getCurrentCycle();
@@ -1182,7 +1364,9 @@ void Processor::retire() {
       }
     }
     ++ m_q_retire;
+    ++ num_retired;
   }
+  accountRetireCycle(num_retired);
 }
 
 void Processor::logUnalignedDataMemoryOperation(DynamicInst &dyn_uop, W64 addr, bool is_load){
@@ -1294,9 +1478,13 @@ void Processor::stepCycle(void){
 
 void
 Processor::fetch() {
+  HOST_PROFILE_SCOPE(HOST_PROFILE_FETCH);
   bool taken_branch = false;
 
   for (int i = 0 ; i < g_x86_fetch_width ; ++ i) {
+    if (getCurrentCycle() < m_fetch_resume_cycle) { // redirect after a BTB miss
+      break;
+    }
     if (m_q_oldest_bad != (QPointer)-1) { // don't bother if pipeline is already doomed
       break;
     }
@@ -1406,6 +1594,8 @@ Processor::dataCollect() {
 }
 
 void Processor::print(void) {
+  CpiStack::print(cout, m_processor_number);
+
   if (strcmp(g_params.getPredictorAccuracyFilePath().c_str(), "/dev/null") != 0) {
     string predictorAccuracyFilePath = g_params.getPredictorAccuracyFilePath();
     if (SIM_number_processors() > 1) {
@@ -1449,6 +1639,63 @@ Processor::cachePermissionChangeNotification(Waddr addr, AccessPermission old_pe
   }
 }
 
+void
+Processor::resetWarming() {
+  m_warm_rip = 0;
+  m_warm_insn.m_size = 0;
+  m_warm_insn.m_type = PTYPE_MAX;
+  m_warm_insn.m_push_ras = false;
+}
+
+void
+Processor::warmDataAccess(Waddr phys_addr, RequestType type) {
+  if (validRamAddress(phys_addr)) {
+    m_mem_interface->warm(phys_addr, type, false);
+  }
+}
+
+void
+Processor::warmInstructionFetch(Waddr rip, Waddr phys_addr) {
+  if (validRamAddress(phys_addr)) {
+    m_mem_interface->warm(phys_addr, REQUEST_READ, true);
+  }
+
+  // the rest of an instruction that straddles a fetch boundary
+  if ((rip > m_warm_rip) && (rip < m_warm_rip + m_warm_insn.m_size)) {
+    return;
+  }
+
+  // fetching here resolves the previous instruction
+  if (m_warm_insn.m_type != PTYPE_MAX) {
+    m_predictors.warm(m_warm_rip, m_warm_insn.m_type, m_warm_insn.m_push_ras,
+                      m_warm_rip + m_warm_insn.m_size, rip);
+  }
+
+  if (!m_warm_insns.exist(rip)) {
+    WarmInsn insn;
+    decodeForWarming(rip, insn);
+    m_warm_insns.add(rip, insn);
+  }
+  m_warm_rip = rip;
+  m_warm_insn = m_warm_insns.lookup(rip);
+}
+
+void
+Processor::checkpoint(CheckpointWriter& cp) const {
+  cp.beginSection("processor");
+  cp.write(m_processor_number);
+  cp.write(int64(SIM_cycle_count(m_cpu)));
+  m_predictors.checkpoint(cp);
+}
+
+void
+Processor::restore(CheckpointReader& cp) {
+  cp.beginSection("processor");
+  cp.check(m_processor_number, "processor number");
+  cp.check(int64(SIM_cycle_count(m_cpu)), "Simics cycle count");
+  m_predictors.restore(cp);
+}
+
 DynamicInst *
 Processor::getDynamicInst(QPointer logical_index) {
   return &(m_inst_buffer[mappedIndex(logical_index)]);
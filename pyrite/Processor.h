@@ -34,6 +34,8 @@
 #include "RegFile.h"
 #include "LoadStoreQueue.h"
 #include "MemoryInterface.h"
+#include "CpiStack.h"
+#include "PipeTrace.h"
 #include "Event.h"
 #include "Predictor.h"
 #include "PipeStages.h"
@@ -41,9 +43,13 @@
 #include "AccessPermission.h"
 
 class Scheduler;
+class CheckpointWriter;
+class CheckpointReader;
 class real_inst_record_handler_t;
 class real_inst_record_factory_t;
 class DynamicInst;
+struct DynamicInstMemory;
+struct DynamicInstCold;
 
 class Processor : public Context {
 
@@ -56,7 +62,10 @@ private:
   PhysicalFile m_physical_file;
   LogicalFile m_front_end_map, m_retire_map;
 
+  // the instruction window, as parallel per-slot arrays (see DynamicInst.h)
   DynamicInst *m_inst_buffer;
+  DynamicInstMemory *m_inst_memory;
+  DynamicInstCold *m_inst_cold;
   unsigned m_buf_size;
 
   QPointer m_q_head;  // head points to next insertion slot (first empty slot)
@@ -74,6 +83,7 @@ private:
   PipeStages<QPointer> retire_pipe;
 
   W64 m_fetch_rip;
+  Tick m_fetch_resume_cycle;  // fetch is stalled by a BTB miss until then
   W64 m_retire_rip;
 
   PredictorSet m_predictors;
@@ -93,6 +103,24 @@ private:
   bool m_committing;
   bool m_reset_while_committing;
 
+  // the CPI stack charges front end stalls to m_cpi_recovery (CPI_BASE
+  // for none) until a uop at or after m_cpi_recovery_q retires
+  CpiComponent m_cpi_recovery;
+  QPointer m_cpi_recovery_q;
+
+  PipeTrace m_pipe_trace;
+  W64 m_seq_num;  // uops fetched so far, numbers them for the pipeline trace
+
+  // what functional warming needs to know about a decoded x86 instruction
+  struct WarmInsn {
+    unsigned m_size;   // 0 if it did not decode
+    PredType m_type;   // PTYPE_MAX if it is not a branch
+    bool m_push_ras;
+  };
+  Map<Waddr, WarmInsn> m_warm_insns;  // decoded once per rip
+  Waddr m_warm_rip;                   // last instruction fetched while warming
+  WarmInsn m_warm_insn;
+
   unsigned mappedIndex(QPointer logical_index) { return logical_index & (m_buf_size - 1); }
   DynamicInst *getDynamicInst(QPointer logical_index);
   void resetUopBuf(void);
@@ -112,6 +140,7 @@ private:
   void initializeProcessorState(void);
   bool fetchMoreBytes(Waddr &fetch_address, W8 *fetch_buffer, unsigned &num_bytes);
   bool decodeCurrentX86Instruction(bool &taken_branch);
+  void decodeForWarming(Waddr rip, WarmInsn &insn);
 
   void logInvalidOpcodeEvent(InvalidOpcodeException& e);
   void logUnimplementedOpcodeEvent(UnimplementedOpcodeException& e, W64 rip);
@@ -129,6 +158,8 @@ private:
 
   void flushPipeline(QPointer q_first_bad);
   void replay(QPointer q_first_replayed);
+  void startCpiRecovery(CpiComponent reason, QPointer q_first_refetched);
+  void accountRetireCycle(int num_retired);
   real_inst_record_handler_t *setRIRHandler(real_inst_record_handler_t *RIR_handler);
 
 public:
@@ -144,6 +175,11 @@ public:
   EventsQueue &getEventsQueue() { return m_events_queue; }
   LoadStoreQueue &getLSQ() { return m_lsq; }
   PhysicalFile &getPhysicalFile() { return m_physical_file; }
+  //! the slot of the instruction window a uop occupies
+  unsigned getWindowSlot(QPointer q) { return mappedIndex(q); }
+  //! a physical register the uop in this slot waited on is ready
+  void wakeupSlot(unsigned slot);
+  PipeTrace &getPipeTrace() { return m_pipe_trace; }
   void cacheAccess(Waiter *w, RequestType t, Waddr addr);
   bool cacheReady();
   MemoryInterface *getMemoryInterface() { return m_mem_interface; }
@@ -182,6 +218,17 @@ public:
 
   void cachePermissionChangeNotification(Waddr a, AccessPermission old_perm, AccessPermission new_perm);
 
+  // functional warming: Simics runs ahead and hands us every access it
+  // makes, which train the caches and (for fetches) the predictors
+  void resetWarming();
+  void warmDataAccess(Waddr phys_addr, RequestType type);
+  void warmInstructionFetch(Waddr rip, Waddr phys_addr);
+
+  // save and restore the warmed predictor state; the Simics cycle
+  // count ties a checkpoint to the point in the run it was taken at
+  void checkpoint(CheckpointWriter& cp) const;
+  void restore(CheckpointReader& cp);
+
   void print(void);
 }; // end class Processor
 
@@ -33,55 +33,97 @@
 /******************** Physical Register File *********************/
 /*****************************************************************/
 
-PhysicalFile::PhysicalFile() {
+PhysicalFile::PhysicalFile()
+  : m_processor(0), m_num_registers(0), m_num_free(0),
+    m_window_slots(0), m_slot_words(0), m_free_hint(0) {
+}
+
+void
+PhysicalFile::init(Processor *processor, int num_registers, unsigned window_slots) {
+  if (num_registers == 0) {
+    /* every live register is mapped by the retire map or written by a
+       uop in the window, plus one spare for each map's REG_zero */
+    num_registers = NUM_REGISTERS + window_slots + 2;
+  }
+  /* with the window empty, the rename maps and REG_zero spares hold
+     the registers allocated at reset; the next x86 op needs the rest */
+  if (num_registers < NUM_REGISTERS + MAX_X86_OP_REGISTERS + 2) {
+    ERROR_MSG("physicalRegisters must cover the rename maps and the largest x86 op");
+  }
+  m_processor = processor;
+  m_num_registers = num_registers;
+  m_window_slots = window_slots;
+  m_slot_words = (window_slots + 63) / 64;
+
+  m_values.assign(num_registers, 0);
+  m_flags.assign(num_registers, 0);
+  m_writers.assign(num_registers, 0);
+  m_ref_counts.assign(num_registers, 0);
+  m_ready.assign((num_registers + 63) / 64, 0);
+  m_free.assign((num_registers + 63) / 64, 0);
+  m_consumers.assign(num_registers * m_slot_words, 0);
+  reset();
 }
 
 PhysName 
 PhysicalFile::allocate() {
-  if (!m_free_list.empty()) {
-    //! if the stack isn't empty, pop one off the stack
-    PhysName ret_val = m_free_list.back();
-    assert(!m_ready[ret_val]);
-    m_free_list.pop_back();
-    return ret_val;
+  assert(hasFree());
+  while (!m_free[m_free_hint]) {
+    ++m_free_hint;
   }
-  //! otherwise allocate & initialize a new one
-  PhysName name = m_values.size();
-  assert(m_values.size() == m_ready.size());
-  PhysReg temp = 0;
-  m_values.push_back(temp);
-  m_flags.push_back(temp);
-  m_writers.push_back(0);
-  m_waitlists.push_back(new WaitList);
-  m_ready.push_back(false);
-  m_ref_counts.push_back(0);
-  assert(m_values.size() == m_ready.size());
+  PhysName name = (m_free_hint << 6) + __builtin_ctzll(m_free[m_free_hint]);
+  m_free[m_free_hint] &= m_free[m_free_hint] - 1;
+  --m_num_free;
+  assert(!isReady(name) && !m_ref_counts[name]);
   return name;
 }
 
 void 
 PhysicalFile::deAllocate(PhysName num) {
   assert(m_ref_counts[num] == 0);
-  assert(m_waitlists[num]->empty());
+  for (unsigned w = 0; w < m_slot_words; ++w) {
+    assert(m_consumers[num * m_slot_words + w] == 0);
+  }
   m_writers[num] = 0;
-  m_ready[num] = false;
-  m_free_list.push_back(num);
+  m_ready[num >> 6] &= ~((W64)1 << (num & 63));
+  m_free[num >> 6] |= (W64)1 << (num & 63);
+  m_free_hint = std::min(m_free_hint, (unsigned)(num >> 6));
+  ++m_num_free;
+}
+
+void
+PhysicalFile::setReady(PhysName i) {
+  assert(m_ref_counts[i]);
+  m_ready[i >> 6] |= (W64)1 << (i & 63);
+  /* wakeup all instructions waiting for this register.  The mask is
+     cleared first: a woken uop may go on to wait on another register */
+  W64 *consumers = &m_consumers[i * m_slot_words];
+  for (unsigned w = 0; w < m_slot_words; ++w) {
+    W64 woken = consumers[w];
+    consumers[w] = 0;
+    while (woken) {
+      unsigned slot = (w << 6) + __builtin_ctzll(woken);
+      woken &= woken - 1;
+      m_processor->wakeupSlot(slot);
+    }
+  }
 }
 
 void
 PhysicalFile::reset() {
-  // Be careful not to leak memory!
-  m_values.clear();
-  m_flags.clear();
-  m_writers.clear();
-  m_ready.clear();
-  m_ref_counts.clear();
-  m_free_list.clear();
-  for(std::vector<WaitList*>::iterator i = m_waitlists.begin();
-      i != m_waitlists.end(); ++i) {
-    delete *i;
+  std::fill(m_values.begin(), m_values.end(), 0);
+  std::fill(m_flags.begin(), m_flags.end(), 0);
+  std::fill(m_writers.begin(), m_writers.end(), 0);
+  std::fill(m_ref_counts.begin(), m_ref_counts.end(), 0);
+  std::fill(m_ready.begin(), m_ready.end(), 0);
+  std::fill(m_consumers.begin(), m_consumers.end(), 0);
+  /* everything is free, except the bits past the last register */
+  std::fill(m_free.begin(), m_free.end(), ~(W64)0);
+  if (m_num_registers & 63) {
+    m_free.back() = ((W64)1 << (m_num_registers & 63)) - 1;
   }
-  m_waitlists.clear();
+  m_free_hint = 0;
+  m_num_free = m_num_registers;
 }
 
 /*****************************************************************/
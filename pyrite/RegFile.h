@@ -45,13 +45,19 @@
 #include "Waiter.h"
 #include "QPointer.h"
 
+//! architectural (logical) registers, the size of a rename map
 const int NUM_REGISTERS = 80;
 
+//! registers the uops of the largest x86 op can write.  An x86 op
+//! retires as a whole, so they are all renamed before any is freed.
+const int MAX_X86_OP_REGISTERS = 20;
+
 typedef W32s PhysName;
 typedef W32s LogicalName;
 typedef W64 PhysReg;
 
 class LogicalFile;
+class Processor;
 
 //! we keep two special register names, one for reading zeroes and one
 //! for writing things that should never be read.
@@ -76,19 +82,34 @@ const PhysName REG_NULL_DEST = -2;
 /******************** Physical Register File *********************/
 /*****************************************************************/
 
+/* The file is a fixed number of registers stored as parallel arrays.
+   Ready and free bits are packed 64 to a word, so allocation is a bit
+   scan.  Instead of a wait list, each register has a bitmask with one
+   bit per instruction window slot for the uops waiting on it; when
+   the value arrives the mask is scanned and each waiting uop is woken
+   up through the processor.
+*/
+
 class PhysicalFile {
   friend class LogicalFile;
 public:
   PhysicalFile(); // constructor
 
+  //! size the file; num_registers == 0 picks enough registers for the
+  //! rename maps and a full window, so rename never stalls on them
+  void init(Processor *processor, int num_registers, unsigned window_slots);
   void reset();
 
+  int getNumRegisters() const { return m_num_registers; }
+  int getNumFree() const { return m_num_free; }
+  bool hasFree() const { return m_num_free != 0; }
+
   /****************** Register Ready Information *******************/
   bool isReady(PhysName num) const {
     /* we should never read from REG_NULL_DEST or REG_NULL_SRC */
-    assert(m_ref_counts[num]);
     assert((num != REG_NULL_DEST) && (num != REG_NULL_SRC));
-    return m_ready[num];
+    assert(m_ref_counts[num]);
+    return (m_ready[num >> 6] >> (num & 63)) & 1;
   }
 
   /****************** Getting and Setting Values *******************/
@@ -124,16 +145,24 @@ public:
 
   void decrementRefCount(PhysName num) {
     assert((num != REG_NULL_DEST) && (num != REG_NULL_SRC));
+    assert(m_ref_counts[num]);
     --m_ref_counts[num];
     if (!m_ref_counts[num]) deAllocate(num);
   }
 
   /******************* Waiting on Registers ************************/
 
-  //! Add a waiter to the wait list
-  void addWaiter(PhysName num, Waiter *w) {
-    assert(m_ref_counts[num]);
-    m_waitlists[num]->insertWaiter(w);
+  //! the uop in window slot "slot" waits for register num
+  void addConsumer(PhysName num, unsigned slot) {
+    assert(m_ref_counts[num] && !isReady(num));
+    assert(slot < m_window_slots);
+    m_consumers[num * m_slot_words + (slot >> 6)] |= (W64)1 << (slot & 63);
+  }
+
+  //! the uop in window slot "slot" no longer waits (it was squashed)
+  void removeConsumer(PhysName num, unsigned slot) {
+    assert(slot < m_window_slots);
+    m_consumers[num * m_slot_words + (slot >> 6)] &= ~((W64)1 << (slot & 63));
   }
 
   /******************* Who wrote this Registers *********************/
@@ -145,27 +174,27 @@ protected:
   PhysName allocate();
   void deAllocate(PhysName num); 
 
-  void setReady(PhysName i) {
-    assert(m_ref_counts[i]);
-    m_ready[i] = true;
-    /* wakeup all instructions waiting for this instruction */
-    m_waitlists[i]->wakeupAll();
-  }
+  void setReady(PhysName i);
 
-  /* values, writers, and wait lists */
-  std::vector<PhysReg> m_values; /* physical registers */
-  std::vector<PhysReg> m_flags; /*  flags registers */
-  std::vector<QPointer> m_writers; /* q_pointer of instruction that wrote this reg */
-  std::vector<WaitList *> m_waitlists; /* wait lists */
+  Processor *m_processor;  /* wakes up the uops in a window slot */
+  int m_num_registers;
+  int m_num_free;
+  unsigned m_window_slots;
+  unsigned m_slot_words;   /* words per consumer mask */
 
-  /* ready bits for each register */
-  std::vector<bool> m_ready;
+  /* values, flags, writers and reference counts, one per register */
+  std::vector<PhysReg> m_values;
+  std::vector<PhysReg> m_flags;
+  std::vector<QPointer> m_writers; /* q_pointer of instruction that wrote this reg */
+  std::vector<W32> m_ref_counts;
 
-  /* reference counts for each register */
-  std::vector<PhysName> m_ref_counts;
+  /* bitsets over registers */
+  std::vector<W64> m_ready;
+  std::vector<W64> m_free;
+  unsigned m_free_hint;    /* no word below this one has a free register */
 
-  /* currently unallocated registers */
-  std::vector<PhysName> m_free_list;
+  /* m_slot_words words per register: the window slots waiting on it */
+  std::vector<W64> m_consumers;
 };
 
 /*****************************************************************/
@@ -34,6 +34,7 @@
 #include "Sequencer.h"
 #include "Waiter.h"
 #include "PyriteDriver.h"
+#include "EventQueue.h"
 
 extern unsigned g_L2_latency;
 
@@ -63,7 +64,7 @@ RubyMemoryInterface::request(Waddr addr, RequestType type, Waiter *requester) {
   }
 
   assert(m_requested_lines.find(line_addr) == m_requested_lines.end());
-  m_requested_lines.insert(std::make_pair(line_addr, new MissedLineWaitList(type)));
+  m_requested_lines.insert(std::make_pair(line_addr, new MissedLineWaitList(type, m_processor->getCurrentCycle())));
 
   CacheMsg request(Address(line_addr), ((type == REQUEST_WRITE) ? CacheRequestType_ST : CacheRequestType_LD),
                    /* local_ProgramCounter */ Address(0), AccessModeType_UserMode,
@@ -83,3 +84,24 @@ RubyMemoryInterface::ready() const {
   CacheMsg nullRequest;
   return g_system_ptr->getSequencer(m_processor->getProcNum())->isReady(nullRequest);
 }
+
+// Warm requests are marked as prefetches so that the Sequencer never
+// calls back into the driver for them.  Hits cost a tag lookup; a miss
+// runs the protocol to completion right away, since nothing is timed.
+void
+RubyMemoryInterface::warm(Waddr addr, RequestType type, bool ifetch) {
+  Sequencer* sequencer = g_system_ptr->getSequencer(m_processor->getProcNum());
+  CacheRequestType ruby_type = ifetch ? CacheRequestType_IFETCH :
+    ((type == REQUEST_WRITE) ? CacheRequestType_ST : CacheRequestType_LD);
+  CacheMsg request(Address(Address(addr).getLineAddress()), ruby_type,
+                   /* local_ProgramCounter */ Address(0), AccessModeType_UserMode,
+                   /* local_Size */4, PrefetchBit_Yes);
+
+  while (!sequencer->empty()) {
+    g_eventQueue_ptr->triggerEvents(g_eventQueue_ptr->getTime() + 100);
+  }
+  sequencer->makeRequest(request);
+  while (!sequencer->empty()) {
+    g_eventQueue_ptr->triggerEvents(g_eventQueue_ptr->getTime() + 100);
+  }
+}
@@ -43,6 +43,7 @@ public:
   // MemoryInterface implementations
   virtual void request(Waddr addr, RequestType type, Waiter *requester);
   virtual bool ready() const;
+  virtual void warm(Waddr addr, RequestType type, bool ifetch);
 };
 
 #endif /* __RUBY_MEMORY_INTERFACE */
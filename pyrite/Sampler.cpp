@@ -0,0 +1,131 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+//===-- Sampler.cpp - SMARTS-style statistical sampling ----------*- C++ -*--=//
+//
+//! Phase bookkeeping and the CPI estimate of a sampled run.
+//
+//===----------------------------------------------------------------------===//
+
+#include <cmath>
+#include "Sampler.h"
+#include "Global.h"
+
+Sampler g_sampler;
+
+Sampler::Sampler()
+  : m_active(false), m_phase(SAMPLE_FAST_FORWARD), m_fast_forward(0), m_warmup(0), m_measure(0),
+    m_confidence(0), m_z(0), m_phase_instructions(0), m_phase_cycles(0),
+    m_measured_instructions(0), m_measured_cycles(0), m_sample_cpi() {
+}
+
+void
+Sampler::start(W64 fast_forward, W64 warmup, W64 measure, int confidence) {
+  //! two-sided standard normal quantiles
+  const int levels[] = {80, 90, 95, 98, 99};
+  const double quantiles[] = {1.282, 1.645, 1.960, 2.326, 2.576};
+
+  m_z = 0;
+  for (int i = 0 ; i < (int) (sizeof(levels) / sizeof(levels[0])) ; i++) {
+    if (levels[i] == confidence) {
+      m_z = quantiles[i];
+    }
+  }
+  if (m_z == 0) {
+    ERROR_MSG("Sampling confidence must be one of 80, 90, 95, 98 or 99 percent");
+  }
+  if (measure == 0) {
+    ERROR_MSG("Sampling needs a measurement length of at least one instruction");
+  }
+
+  m_fast_forward = fast_forward;
+  m_warmup = warmup;
+  m_measure = measure;
+  m_confidence = confidence;
+  m_measured_instructions = m_measured_cycles = 0;
+  m_sample_cpi.clear();
+  m_phase = SAMPLE_FAST_FORWARD;
+  m_active = true;
+}
+
+void
+Sampler::beginDetailed(W64 instructions, W64 cycles) {
+  assert(m_active && (m_phase == SAMPLE_FAST_FORWARD));
+  m_phase = (m_warmup == 0) ? SAMPLE_MEASURE : SAMPLE_WARMUP;
+  m_phase_instructions = instructions;
+  m_phase_cycles = cycles;
+}
+
+void
+Sampler::stepDetailed(W64 instructions, W64 cycles) {
+  assert(m_active && (m_phase != SAMPLE_FAST_FORWARD));
+  W64 retired = instructions - m_phase_instructions;
+
+  if ((m_phase == SAMPLE_WARMUP) && (retired >= m_warmup)) {
+    m_phase = SAMPLE_MEASURE;
+    m_phase_instructions = instructions;
+    m_phase_cycles = cycles;
+  } else if ((m_phase == SAMPLE_MEASURE) && (retired >= m_measure)) {
+    W64 elapsed = cycles - m_phase_cycles;
+    m_sample_cpi.push_back((double) elapsed / (double) retired);
+    m_measured_instructions += retired;
+    m_measured_cycles += elapsed;
+    m_phase = SAMPLE_FAST_FORWARD;
+  }
+}
+
+void
+Sampler::print(std::ostream& out, bool per_sample) const {
+  int n = m_sample_cpi.size();
+  out << "Sampling: fast-forward " << m_fast_forward << ", warmup " << m_warmup
+      << ", measure " << m_measure << " instructions" << std::endl;
+  out << "Samples: " << n << std::endl;
+  if (n == 0) {
+    return;
+  }
+
+  double sum = 0;
+  for (int i = 0 ; i < n ; i++) {
+    sum += m_sample_cpi[i];
+  }
+  double mean = sum / n;
+
+  out << "CPI estimate: " << mean;
+  if (n > 1) {
+    double squares = 0;
+    for (int i = 0 ; i < n ; i++) {
+      squares += (m_sample_cpi[i] - mean) * (m_sample_cpi[i] - mean);
+    }
+    double stddev = sqrt(squares / (n - 1));
+    double half_width = m_z * stddev / sqrt((double) n);
+    out << " +/- " << half_width << " (" << m_confidence << "% confidence, "
+        << 100.0 * half_width / mean << "% relative error, coefficient of variation "
+        << stddev / mean << ")";
+  }
+  out << std::endl;
+  out << "Measured: " << m_measured_instructions << " instructions in "
+      << m_measured_cycles << " cycles" << std::endl;
+
+  if (per_sample) {
+    for (int i = 0 ; i < n ; i++) {
+      out << "sample " << i << " CPI " << m_sample_cpi[i] << std::endl;
+    }
+  }
+}
@@ -0,0 +1,80 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+//===-- Sampler.h - SMARTS-style statistical sampling ------------*- C++ -*--=//
+//
+//! The Sampler drives a sampled run: it fast-forwards functionally for
+//! N x86 instructions, simulates W instructions in detail to warm the
+//! pipeline, measures the CPI of the next U instructions and repeats.
+//! The mean of the per-sample CPIs estimates the CPI of the whole run,
+//! with a confidence interval from their sample standard deviation.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef __SAMPLER_H
+#define __SAMPLER_H
+
+#include <iostream>
+#include <vector>
+#include "globals.h"
+
+class Sampler {
+public:
+  enum Phase {SAMPLE_FAST_FORWARD, SAMPLE_WARMUP, SAMPLE_MEASURE};
+
+  Sampler();
+
+  //! begin sampling; lengths are in x86 instructions and the
+  //! confidence level is in percent
+  void start(W64 fast_forward, W64 warmup, W64 measure, int confidence);
+  void stop() { m_active = false; }
+  bool isActive() const { return m_active; }
+  Phase getPhase() const { return m_phase; }
+  W64 getFastForward() const { return m_fast_forward; }
+
+  //! detailed simulation resumes after a fast-forward, with the
+  //! running totals of retired instructions and cycles
+  void beginDetailed(W64 instructions, W64 cycles);
+
+  //! called every detailed cycle with the running totals; moves on
+  //! to SAMPLE_FAST_FORWARD once a sample has been measured
+  void stepDetailed(W64 instructions, W64 cycles);
+
+  int getNumSamples() const { return m_sample_cpi.size(); }
+
+  //! the estimate and its confidence interval, optionally followed by
+  //! the CPI of every sample
+  void print(std::ostream& out, bool per_sample) const;
+
+private:
+  bool m_active;
+  Phase m_phase;
+  W64 m_fast_forward, m_warmup, m_measure;
+  int m_confidence;
+  double m_z;  // standard normal quantile for m_confidence
+
+  W64 m_phase_instructions, m_phase_cycles;  // totals when the phase began
+  W64 m_measured_instructions, m_measured_cycles;
+  std::vector<double> m_sample_cpi;
+};
+
+extern Sampler g_sampler;
+
+#endif  /* __SAMPLER_H */
@@ -68,9 +68,8 @@ InorderScheduler::select() {
     assert(d != NULL);
     if (d->getQPointer() != m_head) { break; }
     assert(d->isExecuteReady());
-    const TransOp *trans_op = d->getTransOp();
-    bool is_load = isload(trans_op->opcode);
-    bool is_store = isstore(trans_op->opcode);
+    bool is_load = isload(d->getOpcode());
+    bool is_store = isstore(d->getOpcode());
 
     if ((is_load && (num_memory >= g_memory_issue_width)) ||
         (is_store && (num_store >= g_store_issue_width))) {
@@ -117,9 +116,8 @@ OutorderScheduler::select() {
     DynamicInst *d = dynamic_cast<DynamicInst *>(m_next);
     assert(d != NULL);
     assert(d->isExecuteReady());
-    const TransOp *trans_op = d->getTransOp();
-    bool is_load = isload(trans_op->opcode);
-    bool is_store = isstore(trans_op->opcode);
+    bool is_load = isload(d->getOpcode());
+    bool is_store = isstore(d->getOpcode());
 
     if ((is_load && (num_memory >= g_memory_issue_width)) ||
         (is_store && (num_store >= g_store_issue_width))) {
@@ -29,6 +29,7 @@ extern unsigned g_L2_latency;
 extern unsigned g_mem_latency;
 
 cache_t *g_l2_cache = 0;
+static bool s_l2_missed = false;  // set by l2_access_fun during an access
 
 // l1 data cache l1 block miss handler function, returns the latency of a block access
 unsigned int l1d_access_fun(enum mem_cmd cmd /* access cmd, Read or Write */,
@@ -68,6 +69,7 @@ unsigned int l2_access_fun(enum mem_cmd cmd /* access cmd, Read or Write */,
                            struct cache_blk_t *blk /* ptr to block in upper level */,
                            tick_t now /* time of access */) {
   g_stats.incrementL2Misses(0); /* hardcoded to proc 0 stats */
+  s_l2_missed = true;
   /* this is a miss to the lowest level, so access main memory */
   cmd = Read;  // currently treat writes like reads
   if (cmd == Read) {
@@ -123,16 +125,28 @@ SimpleMemoryInterface::request(Waddr addr, RequestType type, Waiter *requester)
     return;
   }
 
+  s_l2_missed = false;
   unsigned int latency = cache_access(m_l1_dcache, (type == REQUEST_READ) ? Read : Write,
                                       line_addr, NULL, 1, m_processor->getCurrentCycle(), NULL, NULL);
   if (latency > 0) {
     m_primary_misses++;
-    m_requested_lines.insert(std::make_pair(line_addr, new MissedLineWaitList(type)));
+    m_requested_lines.insert(std::make_pair(line_addr,
+                                            new MissedLineWaitList(type, m_processor->getCurrentCycle(),
+                                                                   s_l2_missed ? SOURCE_DRAM : SOURCE_L2)));
     if (requester) m_requested_lines[line_addr]->insertWaiter(requester);
     m_processor->getEventsQueue().insert(new SimpleMissWaiter(this, line_addr), latency);
   }
 }
 
+// there is no instruction cache to warm here
+void
+SimpleMemoryInterface::warm(Waddr addr, RequestType type, bool ifetch) {
+  if (!ifetch) {
+    cache_access(m_l1_dcache, (type == REQUEST_READ) ? Read : Write,
+                 Address(addr).getLineAddress(), NULL, 1, m_processor->getCurrentCycle(), NULL, NULL);
+  }
+}
+
 void
 SimpleMemoryInterface::releaseRequest(Waddr request_addr) {
   if (m_requested_lines.find(request_addr) != m_requested_lines.end()) {
@@ -49,6 +49,7 @@ public:
   // MemoryInterface implementations
   void reset();
   void request(Waddr addr, RequestType type, Waiter *requester);
+  void warm(Waddr addr, RequestType type, bool ifetch);
 private:
   cache_t *m_l1_dcache;
 };
@@ -0,0 +1,648 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+//===-- TagePredictor.cpp - TAGE-SC-L and ITTAGE predictors ------*- C++ -*--=//
+//
+//! The TAGE-SC-L and ITTAGE predictors; see TagePredictor.h.
+//
+//===----------------------------------------------------------------------===//
+
+#include <stdlib.h>
+#include "TagePredictor.h"
+#include "Checkpoint.h"
+
+//! commits between agings of the useful bits
+static const W64 TAGE_U_RESET_PERIOD = 1 << 18;
+static const W64 ITTAGE_U_RESET_PERIOD = 1 << 16;
+
+//! geometric series of history lengths, up to MAX_HISTORY
+static const int TAGE_LENGTHS[TageScLPredictor::NUM_TABLES] = 
+  {4, 6, 10, 16, 25, 40, 64, 101, 160, 254, 403, 640};
+static const int ITTAGE_LENGTHS[IttagePredictor::NUM_TABLES] = 
+  {4, 7, 11, 18, 29, 48, 78, 128};
+
+//! history lengths of the statistical corrector's GEHL tables
+static const int SC_LENGTHS[TageScLPredictor::SC_TABLES] = {6, 11, 17, 27};
+
+static inline int
+saturate(int value, int min, int max) {
+  return (value < min) ? min : ((value > max) ? max : value);
+}
+
+//! up to 16 bits of path history, folded to width bits
+static inline unsigned
+foldPath(W64 path, int length, int width) {
+  unsigned p = (unsigned) (path & ((1 << std::min(length, 16)) - 1));
+  return (p ^ (p >> width)) & ((1 << width) - 1);
+}
+
+/*****************************************************************/
+/*************************** TAGE-SC-L ***************************/
+/*****************************************************************/
+
+TageScLPredictor::TageScLPredictor(unsigned window_size)
+  : m_bimodal(1 << BIMODAL_BITS, 2), m_use_alt_on_new(16, 0),
+    m_sc_threshold(35), m_sc_tc(0), m_with_loop(-1), m_tick(0), m_seed(0),
+    m_history(MAX_HISTORY, window_size), m_inflights(window_size) {
+  for (int i = 0 ; i < NUM_TABLES ; i ++) {
+    m_length[i] = TAGE_LENGTHS[i];
+    m_tag_bits[i] = 8 + i / 3;
+    m_index_fold[i] = m_history.addFold(m_length[i], TABLE_BITS);
+    m_tag_fold[i][0] = m_history.addFold(m_length[i], m_tag_bits[i]);
+    m_tag_fold[i][1] = m_history.addFold(m_length[i], m_tag_bits[i] - 1);
+    TageEntry empty = {0, 0, 0};
+    m_tables[i].resize(1 << TABLE_BITS, empty);
+  }
+  for (int i = 0 ; i < SC_TABLES ; i ++) {
+    m_sc_fold[i] = m_history.addFold(SC_LENGTHS[i], SC_BITS);
+  }
+  for (int i = 0 ; i <= SC_TABLES ; i ++) {
+    m_sc[i].resize(1 << SC_BITS, 0);
+  }
+  LoopEntry empty_loop = {0, 0, 0, 0, 0, 0, false, false};
+  m_loops.resize(LOOP_SETS * LOOP_WAYS, empty_loop);
+  m_committed_history = m_history.getState();
+}
+
+unsigned
+TageScLPredictor::tableIndex(Waddr rip, int table) const {
+  unsigned pc = (unsigned) rip;
+  unsigned index = pc ^ (pc >> (TABLE_BITS - table % 4)) ^ m_history.getFold(m_index_fold[table]) ^
+    foldPath(m_history.getPath(), m_length[table], TABLE_BITS);
+  return index & ((1 << TABLE_BITS) - 1);
+}
+
+W16
+TageScLPredictor::tableTag(Waddr rip, int table) const {
+  unsigned pc = (unsigned) rip;
+  unsigned tag = pc ^ m_history.getFold(m_tag_fold[table][0]) ^ (m_history.getFold(m_tag_fold[table][1]) << 1);
+  return (W16) (tag & ((1 << m_tag_bits[table]) - 1));
+}
+
+void
+TageScLPredictor::lookupTage(Waddr rip, Record &record) {
+  record.m_bimodal_index = (unsigned) (rip ^ (rip >> BIMODAL_BITS)) & ((1 << BIMODAL_BITS) - 1);
+  record.m_provider = record.m_alt = -1;
+  for (int i = NUM_TABLES - 1 ; i >= 0 ; i --) {
+    record.m_index[i] = tableIndex(rip, i);
+    record.m_tag[i] = tableTag(rip, i);
+    if (m_tables[i][record.m_index[i]].m_tag == record.m_tag[i]) {
+      if (record.m_provider < 0) {
+        record.m_provider = i;
+      } else if (record.m_alt < 0) {
+        record.m_alt = i;
+      }
+    }
+  }
+
+  record.m_alt_pred = (record.m_alt >= 0) ? 
+    (m_tables[record.m_alt][record.m_index[record.m_alt]].m_ctr >= 0) :
+    (m_bimodal[record.m_bimodal_index] >= 2);
+  if (record.m_provider >= 0) {
+    const TageEntry &entry = m_tables[record.m_provider][record.m_index[record.m_provider]];
+    record.m_provider_pred = (entry.m_ctr >= 0);
+    record.m_provider_new = ((entry.m_ctr == 0) || (entry.m_ctr == -1)) && (entry.m_u == 0);
+    bool use_alt = record.m_provider_new && (m_use_alt_on_new[rip & 15] >= 0);
+    record.m_tage_pred = use_alt ? record.m_alt_pred : record.m_provider_pred;
+  } else {
+    record.m_provider_pred = record.m_alt_pred;
+    record.m_provider_new = false;
+    record.m_tage_pred = record.m_alt_pred;
+  }
+}
+
+void
+TageScLPredictor::lookupLoop(Waddr rip, Record &record) {
+  int set = (int) (rip & (LOOP_SETS - 1));
+  record.m_loop_tag = (W16) ((rip >> 4) & 0x3fff);
+  record.m_loop_index = -1;
+  record.m_loop_valid = false;
+  record.m_loop_pred = false;
+  for (int way = 0 ; way < LOOP_WAYS ; way ++) {
+    const LoopEntry &entry = m_loops[set * LOOP_WAYS + way];
+    if (entry.m_valid && (entry.m_tag == record.m_loop_tag)) {
+      record.m_loop_index = set * LOOP_WAYS + way;
+      record.m_loop_spec_iter = entry.m_spec_iter;
+      record.m_loop_valid = (entry.m_confidence == 3);
+      record.m_loop_pred = ((entry.m_spec_iter + 1) == entry.m_past_iter) ? !entry.m_dir : entry.m_dir;
+      return;
+    }
+  }
+}
+
+void
+TageScLPredictor::lookupSC(Waddr rip, Record &record) {
+  // the bias table also sees how confident TAGE was
+  int confidence = 1;
+  if (record.m_provider >= 0) {
+    int ctr = m_tables[record.m_provider][record.m_index[record.m_provider]].m_ctr;
+    confidence = record.m_provider_new ? 0 : (((ctr == 3) || (ctr == -4)) ? 2 : 1);
+  }
+  unsigned pc = (unsigned) (rip ^ (rip >> SC_BITS));
+  record.m_sc_index[0] = ((pc << 3) | (confidence << 1) | record.m_tage_pred) & ((1 << SC_BITS) - 1);
+  for (int i = 0 ; i < SC_TABLES ; i ++) {
+    unsigned fold = m_history.getFold(m_sc_fold[i]);
+    record.m_sc_index[i + 1] = (pc ^ fold ^ (record.m_tage_pred << i)) & ((1 << SC_BITS) - 1);
+  }
+
+  record.m_sc_sum = 0;
+  for (int i = 0 ; i <= SC_TABLES ; i ++) {
+    record.m_sc_sum += 2 * m_sc[i][record.m_sc_index[i]] + 1;
+  }
+}
+
+bool
+TageScLPredictor::predict(Waddr rip, QPointer q_ptr) {
+  Record &record = m_inflights.save(q_ptr);
+  record.m_history = m_history.getState();
+  record.m_rip = rip;
+
+  lookupTage(rip, record);
+  lookupLoop(rip, record);
+  lookupSC(rip, record);
+
+  bool pred = record.m_tage_pred;
+  record.m_loop_used = record.m_loop_valid && (m_with_loop >= 0);
+  if (record.m_loop_used) {
+    pred = record.m_loop_pred;
+  } else if (((record.m_sc_sum >= 0) != record.m_tage_pred) && 
+             (abs(record.m_sc_sum) >= m_sc_threshold)) {
+    pred = !pred;
+  }
+  record.m_pred = record.m_dir = pred;
+
+  m_history.push(pred, rip);
+  if (LoopEntry *entry = loopEntry(record)) {
+    advanceLoop(entry, pred);
+  }
+  return pred;
+}
+
+void
+TageScLPredictor::resolve(QPointer q_ptr, bool taken) {
+  m_inflights.get(q_ptr).m_dir = taken;
+}
+
+TageScLPredictor::LoopEntry *
+TageScLPredictor::loopEntry(const Record &record) {
+  if (record.m_loop_index < 0) {
+    return NULL;
+  }
+  LoopEntry &entry = m_loops[record.m_loop_index];
+  // it may have been replaced since the branch looked it up
+  return (entry.m_valid && (entry.m_tag == record.m_loop_tag)) ? &entry : NULL;
+}
+
+void
+TageScLPredictor::squash(QPointer first_bad) {
+  // undo the speculative loop iterations youngest first
+  while (!m_inflights.empty() && (m_inflights.youngestQPointer() >= first_bad)) {
+    const Record &record = m_inflights.youngest();
+    if (LoopEntry *entry = loopEntry(record)) {
+      entry->m_spec_iter = record.m_loop_spec_iter;
+    }
+    m_inflights.squash(m_inflights.youngestQPointer());
+  }
+
+  if (m_inflights.empty()) {
+    m_history.setState(m_committed_history);
+    for (unsigned i = 0 ; i < m_loops.size() ; i ++) {
+      m_loops[i].m_spec_iter = m_loops[i].m_current_iter;
+    }
+  } else {
+    // redo the youngest survivor, whose direction may have been resolved
+    const Record &record = m_inflights.youngest();
+    m_history.setState(record.m_history);
+    m_history.push(record.m_dir, record.m_rip);
+    if (LoopEntry *entry = loopEntry(record)) {
+      entry->m_spec_iter = record.m_loop_spec_iter;
+      advanceLoop(entry, record.m_dir);
+    }
+  }
+}
+
+void
+TageScLPredictor::updateTage(const Record &record, bool taken) {
+  bool mispredicted = (record.m_tage_pred != taken);
+
+  // allocate longer-history entries, unless the provider was right and
+  // only the choice of the alternate prediction was wrong
+  if (mispredicted && (record.m_provider < NUM_TABLES - 1) &&
+      !((record.m_provider >= 0) && (record.m_provider_pred == taken))) {
+    int start = record.m_provider + 1;
+    if ((start < NUM_TABLES - 1) && (random() & 1)) {
+      ++ start;
+    }
+    bool allocated = false;
+    for (int i = start ; i < NUM_TABLES ; i ++) {
+      TageEntry &entry = m_tables[i][record.m_index[i]];
+      if (entry.m_u == 0) {
+        entry.m_tag = record.m_tag[i];
+        entry.m_ctr = taken ? 0 : -1;
+        allocated = true;
+        break;
+      }
+    }
+    if (!allocated) {
+      for (int i = record.m_provider + 1 ; i < NUM_TABLES ; i ++) {
+        TageEntry &entry = m_tables[i][record.m_index[i]];
+        if (entry.m_u > 0) {
+          -- entry.m_u;
+        }
+      }
+    }
+  }
+
+  if (record.m_provider >= 0) {
+    TageEntry &entry = m_tables[record.m_provider][record.m_index[record.m_provider]];
+    if (record.m_provider_new && (record.m_provider_pred != record.m_alt_pred)) {
+      signed char &use_alt = m_use_alt_on_new[record.m_rip & 15];
+      use_alt = saturate(use_alt + ((record.m_alt_pred == taken) ? 1 : -1), -8, 7);
+    }
+    // a new entry has not earned its place yet, train the alternate too
+    if (entry.m_u == 0) {
+      if (record.m_alt >= 0) {
+        TageEntry &alt = m_tables[record.m_alt][record.m_index[record.m_alt]];
+        alt.m_ctr = saturate(alt.m_ctr + (taken ? 1 : -1), -4, 3);
+      } else {
+        unsigned char &counter = m_bimodal[record.m_bimodal_index];
+        counter = saturate(counter + (taken ? 1 : -1), 0, 3);
+      }
+    }
+    entry.m_ctr = saturate(entry.m_ctr + (taken ? 1 : -1), -4, 3);
+    if (record.m_provider_pred != record.m_alt_pred) {
+      entry.m_u = saturate(entry.m_u + ((record.m_provider_pred == taken) ? 1 : -1), 0, 3);
+    }
+  } else {
+    unsigned char &counter = m_bimodal[record.m_bimodal_index];
+    counter = saturate(counter + (taken ? 1 : -1), 0, 3);
+  }
+
+  // age the useful bits so stale entries can be replaced
+  if ((++ m_tick % TAGE_U_RESET_PERIOD) == 0) {
+    for (int i = 0 ; i < NUM_TABLES ; i ++) {
+      for (unsigned j = 0 ; j < m_tables[i].size() ; j ++) {
+        m_tables[i][j].m_u >>= 1;
+      }
+    }
+  }
+}
+
+void
+TageScLPredictor::updateLoop(const Record &record, bool taken) {
+  if (record.m_loop_valid && (record.m_loop_pred != record.m_tage_pred)) {
+    m_with_loop = saturate(m_with_loop + ((record.m_loop_pred == taken) ? 1 : -1), -64, 63);
+  }
+
+  LoopEntry *entry = loopEntry(record);
+  if (entry != NULL) {
+    if (record.m_loop_valid && (record.m_loop_pred != taken)) {
+      // a confident loop mispredicted: the trip count is not regular
+      entry->m_valid = false;
+      return;
+    }
+    if (record.m_loop_valid && (record.m_loop_pred != record.m_tage_pred) && (entry->m_age < 255)) {
+      ++ entry->m_age;
+    }
+
+    ++ entry->m_current_iter;
+    if (entry->m_current_iter == 0xffff) {  // not a loop we can count
+      entry->m_valid = false;
+      return;
+    }
+    if (taken != entry->m_dir) {  // left the loop
+      if (entry->m_past_iter == 0) {
+        entry->m_past_iter = entry->m_current_iter;
+      } else if (entry->m_current_iter == entry->m_past_iter) {
+        if (entry->m_confidence < 3) {
+          ++ entry->m_confidence;
+        }
+      } else {
+        entry->m_valid = false;
+        return;
+      }
+      // loops of one or two iterations are left to TAGE
+      if (entry->m_past_iter < 3) {
+        entry->m_valid = false;
+        return;
+      }
+      entry->m_current_iter = 0;
+    }
+  } else if ((record.m_tage_pred != taken) && ((random() & 3) == 0)) {
+    // take the exit TAGE just missed as the end of a loop
+    int set = (int) (record.m_rip & (LOOP_SETS - 1));
+    for (int way = 0 ; way < LOOP_WAYS ; way ++) {
+      LoopEntry &victim = m_loops[set * LOOP_WAYS + way];
+      if (!victim.m_valid || (victim.m_age == 0)) {
+        victim.m_valid = true;
+        victim.m_tag = record.m_loop_tag;
+        victim.m_dir = !taken;
+        victim.m_past_iter = 0;
+        victim.m_current_iter = victim.m_spec_iter = 0;
+        victim.m_confidence = 0;
+        victim.m_age = 255;
+        return;
+      }
+    }
+    for (int way = 0 ; way < LOOP_WAYS ; way ++) {
+      -- m_loops[set * LOOP_WAYS + way].m_age;
+    }
+  }
+}
+
+void
+TageScLPredictor::updateSC(const Record &record, bool taken) {
+  bool sc_pred = (record.m_sc_sum >= 0);
+  // when it disagrees with TAGE, move the threshold for overriding it
+  if (sc_pred != record.m_tage_pred) {
+    m_sc_tc += (sc_pred == taken) ? -1 : 1;
+    if (m_sc_tc > 31) {
+      ++ m_sc_threshold;
+      m_sc_tc = 0;
+    } else if (m_sc_tc < -32) {
+      m_sc_threshold = std::max(m_sc_threshold - 1, 5);
+      m_sc_tc = 0;
+    }
+  }
+  if ((sc_pred != taken) || (abs(record.m_sc_sum) < m_sc_threshold)) {
+    for (int i = 0 ; i <= SC_TABLES ; i ++) {
+      signed char &ctr = m_sc[i][record.m_sc_index[i]];
+      ctr = saturate(ctr + (taken ? 1 : -1), -32, 31);
+    }
+  }
+}
+
+void
+TageScLPredictor::commit(QPointer q_ptr) {
+  const Record &record = m_inflights.get(q_ptr);
+  bool taken = record.m_dir;
+
+  updateLoop(record, taken);
+  if (!record.m_loop_used) {
+    updateSC(record, taken);
+  }
+  updateTage(record, taken);
+
+  m_committed_history = record.m_history;
+  m_history.push(m_committed_history, taken, record.m_rip);
+  m_inflights.commit(q_ptr);
+}
+
+void
+TageScLPredictor::checkpoint(CheckpointWriter& cp) const {
+  cp.write(NUM_TABLES);
+  cp.write(TABLE_BITS);
+  for (int i = 0 ; i < NUM_TABLES ; i ++) {
+    cp.writeArray(&m_tables[i][0], m_tables[i].size());
+  }
+  cp.writeArray(&m_bimodal[0], m_bimodal.size());
+  cp.writeArray(&m_use_alt_on_new[0], m_use_alt_on_new.size());
+  cp.writeArray(&m_loops[0], m_loops.size());
+  for (int i = 0 ; i <= SC_TABLES ; i ++) {
+    cp.writeArray(&m_sc[i][0], m_sc[i].size());
+  }
+  cp.write(m_sc_threshold);
+  cp.write(m_sc_tc);
+  cp.write(m_with_loop);
+  cp.write(uint64(m_tick));
+  m_history.checkpoint(cp, m_committed_history);
+}
+
+void
+TageScLPredictor::restore(CheckpointReader& cp) {
+  uint64 tick;
+  cp.check(NUM_TABLES, "TAGE tables");
+  cp.check(TABLE_BITS, "TAGE table bits");
+  for (int i = 0 ; i < NUM_TABLES ; i ++) {
+    cp.readArray(&m_tables[i][0], m_tables[i].size());
+  }
+  cp.readArray(&m_bimodal[0], m_bimodal.size());
+  cp.readArray(&m_use_alt_on_new[0], m_use_alt_on_new.size());
+  cp.readArray(&m_loops[0], m_loops.size());
+  for (int i = 0 ; i <= SC_TABLES ; i ++) {
+    cp.readArray(&m_sc[i][0], m_sc[i].size());
+  }
+  cp.read(m_sc_threshold);
+  cp.read(m_sc_tc);
+  cp.read(m_with_loop);
+  cp.read(tick);
+  m_tick = tick;
+  m_history.restore(cp);
+  m_committed_history = m_history.getState();
+  m_inflights.clear();
+  for (unsigned i = 0 ; i < m_loops.size() ; i ++) {
+    m_loops[i].m_spec_iter = m_loops[i].m_current_iter;
+  }
+}
+
+void
+TageScLPredictor::warm(Waddr rip, bool taken) {
+  assert(m_inflights.empty());
+  predict(rip, 0);
+  resolve(0, taken);
+  commit(0);
+}
+
+/*****************************************************************/
+/***************************** ITTAGE ****************************/
+/*****************************************************************/
+
+IttagePredictor::IttagePredictor(unsigned window_size)
+  : m_base(1 << BASE_BITS, 0), m_tick(0), m_seed(0),
+    m_history(MAX_HISTORY, TARGET_BITS * window_size), m_inflights(window_size) {
+  for (int i = 0 ; i < NUM_TABLES ; i ++) {
+    m_length[i] = ITTAGE_LENGTHS[i];
+    m_tag_bits[i] = 9 + i / 4;
+    m_index_fold[i] = m_history.addFold(m_length[i], TABLE_BITS);
+    m_tag_fold[i][0] = m_history.addFold(m_length[i], m_tag_bits[i]);
+    m_tag_fold[i][1] = m_history.addFold(m_length[i], m_tag_bits[i] - 1);
+    Entry empty = {0, 0, 0, 0};
+    m_tables[i].resize(1 << TABLE_BITS, empty);
+  }
+  m_committed_history = m_history.getState();
+}
+
+//! the history holds a few hashed bits of each indirect branch's target
+void
+IttagePredictor::pushTarget(GlobalHistory::State &state, Waddr rip, Waddr target) {
+  Waddr hash = target ^ (target >> 3) ^ (target >> 7);
+  for (int i = 0 ; i < TARGET_BITS ; i ++) {
+    m_history.push(state, (hash >> i) & 1, rip >> i);
+  }
+}
+
+Waddr
+IttagePredictor::predict(Waddr rip, QPointer q_ptr) {
+  Record &record = m_inflights.save(q_ptr);
+  record.m_history = m_history.getState();
+  record.m_rip = rip;
+
+  unsigned pc = (unsigned) rip;
+  record.m_base_index = (pc ^ (pc >> BASE_BITS)) & ((1 << BASE_BITS) - 1);
+  record.m_provider = record.m_alt = -1;
+  for (int i = NUM_TABLES - 1 ; i >= 0 ; i --) {
+    unsigned index = pc ^ (pc >> (TABLE_BITS - i % 4)) ^ m_history.getFold(m_index_fold[i]) ^
+      foldPath(m_history.getPath(), m_length[i], TABLE_BITS);
+    unsigned tag = pc ^ m_history.getFold(m_tag_fold[i][0]) ^ (m_history.getFold(m_tag_fold[i][1]) << 1);
+    record.m_index[i] = index & ((1 << TABLE_BITS) - 1);
+    record.m_tag[i] = (W16) (tag & ((1 << m_tag_bits[i]) - 1));
+    if (m_tables[i][record.m_index[i]].m_tag == record.m_tag[i]) {
+      if (record.m_provider < 0) {
+        record.m_provider = i;
+      } else if (record.m_alt < 0) {
+        record.m_alt = i;
+      }
+    }
+  }
+
+  record.m_alt_target = (record.m_alt >= 0) ? 
+    m_tables[record.m_alt][record.m_index[record.m_alt]].m_target : m_base[record.m_base_index];
+  record.m_pred = record.m_alt_target;
+  if (record.m_provider >= 0) {
+    const Entry &entry = m_tables[record.m_provider][record.m_index[record.m_provider]];
+    // an unconfident provider defers to the alternate prediction
+    if ((entry.m_confidence > 0) || (record.m_alt < 0)) {
+      record.m_pred = entry.m_target;
+    }
+  }
+  record.m_target = record.m_pred;
+
+  GlobalHistory::State state = m_history.getState();
+  pushTarget(state, rip, record.m_pred);
+  m_history.setState(state);
+  return record.m_pred;
+}
+
+void
+IttagePredictor::resolve(QPointer q_ptr, Waddr target) {
+  m_inflights.get(q_ptr).m_target = target;
+}
+
+void
+IttagePredictor::squash(QPointer first_bad) {
+  m_inflights.squash(first_bad);
+  if (m_inflights.empty()) {
+    m_history.setState(m_committed_history);
+  } else {
+    const Record &record = m_inflights.youngest();
+    GlobalHistory::State state = record.m_history;
+    pushTarget(state, record.m_rip, record.m_target);
+    m_history.setState(state);
+  }
+}
+
+void
+IttagePredictor::commit(QPointer q_ptr) {
+  const Record &record = m_inflights.get(q_ptr);
+  Waddr target = record.m_target;
+
+  // allocate a longer-history entry for a mispredicted target
+  if ((record.m_pred != target) && (record.m_provider < NUM_TABLES - 1)) {
+    int start = record.m_provider + 1;
+    if ((start < NUM_TABLES - 1) && (random() & 1)) {
+      ++ start;
+    }
+    bool allocated = false;
+    for (int i = start ; i < NUM_TABLES ; i ++) {
+      Entry &entry = m_tables[i][record.m_index[i]];
+      if (entry.m_u == 0) {
+        entry.m_tag = record.m_tag[i];
+        entry.m_target = target;
+        entry.m_confidence = 0;
+        allocated = true;
+        break;
+      }
+    }
+    if (!allocated) {
+      for (int i = record.m_provider + 1 ; i < NUM_TABLES ; i ++) {
+        m_tables[i][record.m_index[i]].m_u = 0;
+      }
+    }
+  }
+
+  if (record.m_provider >= 0) {
+    Entry &entry = m_tables[record.m_provider][record.m_index[record.m_provider]];
+    bool provider_correct = (entry.m_target == target);
+    bool alt_correct = (record.m_alt_target == target);
+    if (provider_correct != alt_correct) {
+      entry.m_u = provider_correct ? 1 : 0;
+    }
+    if (provider_correct) {
+      entry.m_confidence = std::min(entry.m_confidence + 1, 3);
+    } else if (entry.m_confidence == 0) {
+      entry.m_target = target;
+    } else {
+      -- entry.m_confidence;
+    }
+    if ((entry.m_confidence == 0) && (record.m_alt < 0)) {
+      m_base[record.m_base_index] = target;
+    }
+  } else {
+    m_base[record.m_base_index] = target;
+  }
+
+  if ((++ m_tick % ITTAGE_U_RESET_PERIOD) == 0) {
+    for (int i = 0 ; i < NUM_TABLES ; i ++) {
+      for (unsigned j = 0 ; j < m_tables[i].size() ; j ++) {
+        m_tables[i][j].m_u = 0;
+      }
+    }
+  }
+
+  m_committed_history = record.m_history;
+  pushTarget(m_committed_history, record.m_rip, target);
+  m_inflights.commit(q_ptr);
+}
+
+void
+IttagePredictor::checkpoint(CheckpointWriter& cp) const {
+  cp.write(NUM_TABLES);
+  cp.write(TABLE_BITS);
+  for (int i = 0 ; i < NUM_TABLES ; i ++) {
+    cp.writeArray(&m_tables[i][0], m_tables[i].size());
+  }
+  cp.writeArray(&m_base[0], m_base.size());
+  cp.write(uint64(m_tick));
+  m_history.checkpoint(cp, m_committed_history);
+}
+
+void
+IttagePredictor::restore(CheckpointReader& cp) {
+  uint64 tick;
+  cp.check(NUM_TABLES, "ITTAGE tables");
+  cp.check(TABLE_BITS, "ITTAGE table bits");
+  for (int i = 0 ; i < NUM_TABLES ; i ++) {
+    cp.readArray(&m_tables[i][0], m_tables[i].size());
+  }
+  cp.readArray(&m_base[0], m_base.size());
+  cp.read(tick);
+  m_tick = tick;
+  m_history.restore(cp);
+  m_committed_history = m_history.getState();
+  m_inflights.clear();
+}
+
+void
+IttagePredictor::warm(Waddr rip, Waddr target) {
+  assert(m_inflights.empty());
+  predict(rip, 0);
+  resolve(0, target);
+  commit(0);
+}
@@ -0,0 +1,200 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+//===-- TagePredictor.h - TAGE-SC-L and ITTAGE predictors --------*- C++ -*--=//
+//
+//! The TAGE-SC-L direction predictor (Seznec, CBP-5) and the ITTAGE
+//! indirect target predictor.  Both look up a base table and a set of
+//! tagged tables indexed with geometrically longer global histories,
+//! and predict with the longest history that hits.  TAGE-SC-L adds a
+//! loop predictor for regular loop exits and a statistical corrector
+//! that reverts the TAGE predictions it has learned are unreliable.
+//!
+//! Tables are read at predict and trained when the branch commits.
+//! The global history is updated at predict and repaired from the
+//! youngest surviving branch's checkpoint on a squash.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef __TAGE_PREDICTOR_H
+#define __TAGE_PREDICTOR_H
+
+#include <vector>
+#include "Predictor.h"
+#include "BranchHistory.h"
+
+class TageScLPredictor : public DirectPredictor {
+public:
+  TageScLPredictor(unsigned window_size);
+
+  bool predict(Waddr rip, QPointer q_ptr);
+  void resolve(QPointer q_ptr, bool taken);
+  void squash(QPointer first_bad);
+  void commit(QPointer q_ptr);
+  void checkpoint(CheckpointWriter& cp) const;
+  void restore(CheckpointReader& cp);
+  void warm(Waddr rip, bool taken);
+
+  static const int NUM_TABLES = 12;
+  static const int MAX_HISTORY = 640;
+  static const int TABLE_BITS = 10;
+  static const int BIMODAL_BITS = 13;
+  static const int LOOP_SETS = 16;
+  static const int LOOP_WAYS = 4;
+  static const int SC_TABLES = 4;         // GEHL tables, besides the bias table
+  static const int SC_BITS = 10;
+
+private:
+  struct TageEntry {
+    W16 m_tag;
+    signed char m_ctr;          // 3-bit signed, taken if >= 0
+    unsigned char m_u;          // 2-bit useful counter
+  };
+
+  struct LoopEntry {
+    W16 m_tag;
+    W16 m_past_iter;            // iterations of the last complete run
+    W16 m_current_iter;         // committed iterations of this run
+    W16 m_spec_iter;            // the same, counting the predicted ones in flight
+    unsigned char m_confidence;
+    unsigned char m_age;
+    bool m_valid;
+    bool m_dir;                 // the direction that stays in the loop
+  };
+
+  struct Record {
+    GlobalHistory::State m_history;  // before this branch
+    Waddr m_rip;
+    bool m_pred;
+    bool m_dir;                 // predicted, then resolved direction
+    unsigned m_bimodal_index;
+    unsigned m_index[NUM_TABLES];
+    W16 m_tag[NUM_TABLES];
+    int m_provider;             // tagged tables, -1 for the bimodal table
+    int m_alt;
+    bool m_provider_pred;
+    bool m_alt_pred;
+    bool m_provider_new;        // weak and not useful: maybe just allocated
+    bool m_tage_pred;
+    int m_loop_index;           // -1 if the loop predictor missed
+    W16 m_loop_tag;
+    W16 m_loop_spec_iter;       // before this branch
+    bool m_loop_valid;
+    bool m_loop_pred;
+    bool m_loop_used;
+    unsigned m_sc_index[SC_TABLES + 1];
+    int m_sc_sum;
+  };
+
+  unsigned tableIndex(Waddr rip, int table) const;
+  W16 tableTag(Waddr rip, int table) const;
+  void lookupTage(Waddr rip, Record &record);
+  void lookupLoop(Waddr rip, Record &record);
+  void lookupSC(Waddr rip, Record &record);
+
+  void updateTage(const Record &record, bool taken);
+  void updateLoop(const Record &record, bool taken);
+  void updateSC(const Record &record, bool taken);
+  LoopEntry *loopEntry(const Record &record);
+  void advanceLoop(LoopEntry *entry, bool taken) {
+    entry->m_spec_iter = (taken == entry->m_dir) ? (entry->m_spec_iter + 1) : 0;
+  }
+  unsigned random() { m_seed = m_seed * 1103515245 + 12345; return m_seed >> 16; }
+
+  int m_length[NUM_TABLES];
+  int m_tag_bits[NUM_TABLES];
+  int m_index_fold[NUM_TABLES];
+  int m_tag_fold[NUM_TABLES][2];
+  int m_sc_fold[SC_TABLES];
+
+  std::vector<TageEntry> m_tables[NUM_TABLES];
+  std::vector<unsigned char> m_bimodal;
+  std::vector<signed char> m_use_alt_on_new;
+  std::vector<LoopEntry> m_loops;
+  std::vector<signed char> m_sc[SC_TABLES + 1];
+  int m_sc_threshold, m_sc_tc;
+  int m_with_loop;              // trust the loop predictor over TAGE if >= 0
+  W64 m_tick;                   // commits since the useful bits were last aged
+  unsigned m_seed;
+
+  GlobalHistory m_history;
+  GlobalHistory::State m_committed_history;
+  SquashableRing<Record> m_inflights;
+};
+
+class IttagePredictor : public IndirectPredictor {
+public:
+  IttagePredictor(unsigned window_size);
+
+  Waddr predict(Waddr rip, QPointer q_ptr);
+  void resolve(QPointer q_ptr, Waddr target);
+  void squash(QPointer first_bad);
+  void commit(QPointer q_ptr);
+  void checkpoint(CheckpointWriter& cp) const;
+  void restore(CheckpointReader& cp);
+  void warm(Waddr rip, Waddr target);
+
+  static const int NUM_TABLES = 8;
+  static const int MAX_HISTORY = 128;
+  static const int TABLE_BITS = 9;
+  static const int BASE_BITS = 10;
+  //! history bits each indirect branch pushes, hashed from its target
+  static const int TARGET_BITS = 2;
+
+private:
+  struct Entry {
+    Waddr m_target;
+    W16 m_tag;
+    unsigned char m_confidence; // 2 bits
+    unsigned char m_u;          // 1 bit
+  };
+
+  struct Record {
+    GlobalHistory::State m_history;  // before this branch
+    Waddr m_rip;
+    Waddr m_pred;
+    Waddr m_target;             // predicted, then resolved target
+    Waddr m_alt_target;
+    unsigned m_base_index;
+    unsigned m_index[NUM_TABLES];
+    W16 m_tag[NUM_TABLES];
+    int m_provider;             // -1 for the base table
+    int m_alt;
+  };
+
+  void pushTarget(GlobalHistory::State &state, Waddr rip, Waddr target);
+  unsigned random() { m_seed = m_seed * 1103515245 + 12345; return m_seed >> 16; }
+
+  int m_length[NUM_TABLES];
+  int m_tag_bits[NUM_TABLES];
+  int m_index_fold[NUM_TABLES];
+  int m_tag_fold[NUM_TABLES][2];
+
+  std::vector<Entry> m_tables[NUM_TABLES];
+  std::vector<Waddr> m_base;
+  W64 m_tick;
+  unsigned m_seed;
+
+  GlobalHistory m_history;
+  GlobalHistory::State m_committed_history;
+  SquashableRing<Record> m_inflights;
+};
+
+#endif /* __TAGE_PREDICTOR_H */
@@ -45,6 +45,12 @@
 #include "EventQueue.h"
 #include "Param.h"
 #include "Profiler.h"
+#include "Checkpoint.h"
+#include "Sampler.h"
+#include "IntervalStats.h"
+#include "HostProfiler.h"
+#include "HostMemory.h"
+#include "pyrite-magic.h"
 
 using namespace std;
 extern Map<Waddr, string> g_code_map;
@@ -52,6 +58,9 @@ extern Map<Waddr, string> g_code_map;
 static int print_interval = 100000;
 bool g_break_simulation = false;
 bool g_functional_only = false;
+bool g_functional_warming = false;
+static W64 s_warmed_accesses = 0;
+static W64 s_warmed_fetches = 0;
 
 /* to get the correct enums */
 #define TARGET_X86
@@ -65,9 +74,62 @@ extern "C" {
 }
 
 void rubyInit();
+static void start_functional_warming(pyrite_object_t *pyrite);
+static void stop_functional_warming(pyrite_object_t *pyrite, bool report);
+
+static pyrite_object_t *s_pyrite = NULL;
+static bool s_fast_forwarding = false;
 
 static int s_advance_counter = 0;
 
+// Copy the counters Ruby keeps itself into the stats
+static void merge_ruby_stats(void){
+  if (!g_params.getRuby()) {
+    return;
+  }
+  Profiler* profiler = g_system_ptr->getProfiler();
+  for (int i = 0; i < SIM_number_processors(); i++){
+    g_stats.setL1Misses(i, profiler->getNumL1Misses(i));
+    g_stats.setL2Misses(i, profiler->getNumL2Misses(i));
+  }
+  g_stats.setDramReads(profiler->getNumDramReads());
+  g_stats.setDramWrites(profiler->getNumDramWrites());
+}
+
+// Copy the host time profile into the stats
+static void merge_host_profile(void){
+  if (!HostProfiler::isEnabled()) {
+    return;
+  }
+  g_stats.setHostNanoseconds(HostProfiler::getNanoseconds());
+  g_stats.setHostTicksOther(HostProfiler::getTicks(HOST_PROFILE_OTHER));
+  g_stats.setHostTicksSimics(HostProfiler::getTicks(HOST_PROFILE_SIMICS));
+  g_stats.setHostTicksDecode(HostProfiler::getTicks(HOST_PROFILE_DECODE));
+  g_stats.setHostTicksFetch(HostProfiler::getTicks(HOST_PROFILE_FETCH));
+  g_stats.setHostTicksRename(HostProfiler::getTicks(HOST_PROFILE_RENAME));
+  g_stats.setHostTicksExecute(HostProfiler::getTicks(HOST_PROFILE_EXECUTE));
+  g_stats.setHostTicksRetire(HostProfiler::getTicks(HOST_PROFILE_RETIRE));
+  g_stats.setHostTicksRubyEvents(HostProfiler::getTicks(HOST_PROFILE_RUBY_EVENTS));
+  g_stats.setHostTicksControllers(HostProfiler::getTicks(HOST_PROFILE_CONTROLLERS));
+  g_stats.setHostTicksNetwork(HostProfiler::getTicks(HOST_PROFILE_NETWORK));
+  g_stats.setHostTicksDram(HostProfiler::getTicks(HOST_PROFILE_DRAM));
+}
+
+static void merge_host_memory(void){
+  HostMemory::collect();
+  g_stats.setHostPeakRss(HostMemory::getPeakRss());
+  g_stats.setHostRss(HostMemory::getRss());
+  g_stats.setHostMemoryOther(HostMemory::getBytes(HOST_MEMORY_OTHER));
+  g_stats.setHostMemoryPools(HostMemory::getBytes(HOST_MEMORY_POOLS));
+  g_stats.setHostMemoryDirectory(HostMemory::getBytes(HOST_MEMORY_DIRECTORY));
+  g_stats.setHostMemoryDram(HostMemory::getBytes(HOST_MEMORY_DRAM));
+  g_stats.setHostMemoryProfiler(HostMemory::getBytes(HOST_MEMORY_PROFILER));
+  g_stats.setHostMemoryAddressProfiler(HostMemory::getBytes(HOST_MEMORY_ADDRESS_PROFILER));
+  g_stats.setHostMemoryRecorder(HostMemory::getBytes(HOST_MEMORY_RECORDER));
+  g_stats.setHostMemoryLsq(HostMemory::getBytes(HOST_MEMORY_LSQ));
+  g_stats.setHostMemoryCodeMap(HostMemory::getBytes(HOST_MEMORY_CODE_MAP));
+}
+
 static void processors_step_cycle(void){
   if (g_params.getPrintIntermediateStats()) {
     if ((g_stats.getTotalCycles() % print_interval) == 0){
@@ -98,11 +160,18 @@ static void processors_step_cycle(void){
 
   // g_simics_driver.endOfCycle();
   g_stats.incrementTotalCycles();
+  if (g_interval_stats.isDue()) {
+    merge_ruby_stats();
+    merge_host_profile();
+    merge_host_memory();
+    g_interval_stats.sample(g_stats.getTotalCycles());
+  }
   
   if (g_params.getRuby()) {
     // advance ruby time
     s_advance_counter++;
     if (s_advance_counter == g_param_ptr->SIMICS_RUBY_MULTIPLIER()) {
+      HOST_PROFILE_SCOPE(HOST_PROFILE_RUBY_EVENTS);
       Time time = g_eventQueue_ptr->getTime() + 1;
       g_eventQueue_ptr->triggerEvents(time);
       s_advance_counter = 0;
@@ -132,6 +201,14 @@ static void step_n_cycles(int n){
   }
 }
 
+// Drain and join the interval stats writer while the simulator is
+// still intact, rather than from the static destructor at exit
+static void close_interval_stats(void* dont_care, conf_object_t* obj){
+  if (g_interval_stats.isOpen()) {
+    g_interval_stats.close();
+  }
+}
+
 static void init(void){
   if (g_params.getRuby()) {
     printf("RUBY = 1\n");
@@ -141,9 +218,21 @@ static void init(void){
   }
 
   g_stats.init();
+  HostProfiler::reset();
+  if (strcmp(g_params.getIntervalStatsFilePath().c_str(), "/dev/null") != 0) {
+    g_interval_stats.open(g_params.getIntervalStatsFilePath(), g_params.getIntervalStatsCycles(),
+                          g_params.getIntervalStatsRingSize());
+  }
   if (g_params.getPyriteIsControlling()){
     init_processors();
   }
+  SIM_hap_add_callback("Core_Magic_Instruction",
+                       (obj_hap_func_t) myMagicInsnHandler,
+                       NULL);
+  CHECK_SIM_EXCEPTION();
+  SIM_hap_add_callback("Core_At_Exit",
+                       (obj_hap_func_t) close_interval_stats,
+                       NULL);
   CHECK_SIM_EXCEPTION();
 }
 
@@ -175,6 +264,11 @@ void rubyInit() {
   g_param_ptr->set_L1_CACHE_NUM_SETS_BITS(g_params.getL1DataNumSetBits());
   g_param_ptr->set_L2_CACHE_ASSOC(g_params.getL2Assoc());
   g_param_ptr->set_L2_CACHE_NUM_SETS_BITS(g_params.getL2NumSetBits());
+  g_param_ptr->set_L1_CACHE_REPLACEMENT_POLICY(g_params.getL1ReplacementPolicy());
+  g_param_ptr->set_L2_CACHE_REPLACEMENT_POLICY(g_params.getL2ReplacementPolicy());
+
+  g_param_ptr->set_ADDRESS_PROFILER_BUDGET_KB(g_params.getAddressProfilerBudgetKB());
+  g_param_ptr->set_HISTOGRAM_SIGNIFICANT_DIGITS(g_params.getHistogramSignificantDigits());
 
   g_param_ptr->set_DATA_BLOCK_BITS(g_params.getMemoryBlockBits());
 
@@ -186,6 +280,135 @@ void rubyInit() {
   cout << "Done." << endl;
 }
 
+// Let Simics run the processors functionally for the given number of
+// steps (0 runs until something breaks the simulation)
+static void continue_functionally(integer_t steps){
+  HOST_PROFILE_SCOPE(HOST_PROFILE_SIMICS);
+  if (SIM_number_processors() != 1) { 
+    for (int i = 0; i < SIM_number_processors(); i++){
+      conf_object_t* cpu = SIM_get_processor(i);
+      assert(!SIM_processor_enabled(cpu));
+      SIM_enable_processor(cpu);
+    }
+  }
+  SIM_continue(steps);
+  if (SIM_number_processors() != 1) { 
+    for (int i = 0; i < SIM_number_processors(); i++){
+      conf_object_t* cpu = SIM_get_processor(i);
+      assert(SIM_processor_enabled(cpu));
+      SIM_disable_processor(cpu);
+    }
+  }
+}
+
+// Resynchronize the processors with Simics and let Ruby drain
+static void reset_processors(void){
+  for (int i = 0; i < SIM_number_processors(); i++) {
+    g_processors_vec[i]->reset();
+  }
+  if (g_params.getRuby()) {
+    g_eventQueue_ptr->triggerAllEvents();
+  }
+}
+
+static W64 retired_instructions(void){
+  W64 total = 0;
+  for (int i = 0; i < SIM_number_processors(); i++) {
+    total += g_stats.getCorrectlyExecutedX86Instructions(i);
+  }
+  return total;
+}
+
+// One fast-forward of a sampled run; detailed simulation then resumes
+// from wherever Simics got to
+static void sample_fast_forward(void){
+  W64 length = g_sampler.getFastForward();
+  if (length > 0) {
+    bool warming = g_params.getSamplingFunctionalWarming();
+    if (warming) {
+      reset_processors();
+      start_functional_warming(s_pyrite);
+    }
+    s_fast_forwarding = true;
+    continue_functionally(length);
+    s_fast_forwarding = false;
+    if (warming) {
+      stop_functional_warming(s_pyrite, false);
+    }
+  }
+  reset_processors();
+
+  // a magic instruction may have stopped sampling meanwhile
+  if (g_sampler.isActive()) {
+    g_sampler.beginDetailed(retired_instructions(), g_stats.getTotalCycles());
+  }
+}
+
+static void print_samples(void){
+  g_sampler.print(cout, false);
+  if (strcmp(g_params.getSamplingFilePath().c_str(), "/dev/null") != 0) {
+    ofstream samplingFile;
+    samplingFile.open(g_params.getSamplingFilePath().c_str());
+    g_sampler.print(samplingFile, true);
+    samplingFile.close();
+  }
+}
+
+static void start_sampling(void){
+  if (!g_params.getPyriteIsControlling()){
+    g_params.setPyriteIsControlling(true);
+    init_processors();
+  }
+  stop_functional_warming(s_pyrite, true);
+  if (g_functional_only) {
+    g_functional_only = false;
+    SIM_break_cycle( SIM_current_processor(), 1 );
+  }
+
+  printf("START SAMPLING\n");
+  for (int i = 0; i < SIM_number_processors(); i++) {
+    g_processors_vec[i]->dataCollect();
+  }
+  g_sampler.start(g_params.getSamplingFastForward(), g_params.getSamplingWarmup(),
+                  g_params.getSamplingMeasure(), g_params.getSamplingConfidence());
+}
+
+static void stop_sampling(bool break_simulation){
+  if (!g_sampler.isActive()) {
+    return;
+  }
+  g_sampler.stop();
+  printf("STOP SAMPLING\n");
+  print_samples();
+
+  if (break_simulation) {
+    g_break_simulation = true;
+    if (s_fast_forwarding) {
+      SIM_break_cycle( SIM_current_processor(), 1 );
+    }
+  }
+}
+
+// Magic instructions with a PYRITE_MAGIC_* request in %eax start and
+// stop sampling; any other value belongs to somebody else's handler
+void myMagicInsnHandler(void* userData, conf_object_t* cpu, integer_t dontCare){
+  attr_value_t attr = SIM_get_attribute(cpu, "architecture");
+  const char *reg_name = (strcmp(attr.u.string, "x86-64") == 0) ? "rax" : "eax";
+  W64 request = SIM_read_register(cpu, SIM_get_register_number(cpu, reg_name)) & 0xffffffff;
+  CHECK_SIM_EXCEPTION();
+
+  switch (request) {
+    case PYRITE_MAGIC_START_SAMPLING:
+      start_sampling();
+      break;
+    case PYRITE_MAGIC_STOP_SAMPLING:
+      stop_sampling(true);
+      break;
+    default:
+      break;
+  }
+}
+
 void run(void){
   if (!g_params.getPyriteIsControlling()){
     g_params.setPyriteIsControlling(true);
@@ -194,25 +417,19 @@ void run(void){
 
   for(;;){
     if (g_functional_only) {
-      if (SIM_number_processors() != 1) { 
-        for (int i = 0; i < SIM_number_processors(); i++){
-          conf_object_t* cpu = SIM_get_processor(i);
-          assert(!SIM_processor_enabled(cpu));
-          SIM_enable_processor(cpu);
-        }
-      }
-      SIM_continue(0);
-      if (SIM_number_processors() != 1) { 
-        for (int i = 0; i < SIM_number_processors(); i++){
-          conf_object_t* cpu = SIM_get_processor(i);
-          assert(SIM_processor_enabled(cpu));
-          SIM_disable_processor(cpu);
-        }
-      }
+      continue_functionally(0);
+    }
+
+    if (g_sampler.isActive() && (g_sampler.getPhase() == Sampler::SAMPLE_FAST_FORWARD)) {
+      sample_fast_forward();
     }
 
     processors_step_cycle();
 
+    if (g_sampler.isActive() && (g_sampler.getPhase() != Sampler::SAMPLE_FAST_FORWARD)) {
+      g_sampler.stepDetailed(retired_instructions(), g_stats.getTotalCycles());
+    }
+
     if (g_break_simulation){
       g_break_simulation = false;
       break;
@@ -235,12 +452,10 @@ static void print_register_state(void){
 }
 
 static void print_processor_state(void){
+  merge_ruby_stats();
+  merge_host_profile();
+  merge_host_memory();
   for (int i = 0; i < SIM_number_processors(); i++){
-    if (g_params.getRuby()) {
-      // merge ruby miss stats into global stats
-      g_stats.setL1Misses(i, g_system_ptr->getProfiler()->getNumL1Misses(i));
-      g_stats.setL2Misses(i, g_system_ptr->getProfiler()->getNumL2Misses(i));
-    }
     g_processors_vec[i]->print();
   }
   print_register_state();
@@ -256,6 +471,12 @@ void print(void){
   statsFile.close();
 
   g_eventLog.print(cout);
+  HostProfiler::print(cout, g_stats.getTotalCycles());
+  HostMemory::print(cout);
+
+  if (g_sampler.getNumSamples() > 0) {
+    print_samples();
+  }
 
   if (strcmp(g_params.getDisasmFilePath().c_str(), "/dev/null") != 0) {
     ofstream disasmFile;
@@ -313,7 +534,85 @@ static set_error_t set_print_parameter(void *dont_care, conf_object_t *obj, attr
 
 }
 
+// Functional warming makes pyrite the timing model of every processor's
+// physical memory space, so Simics hands it each access while running
+// ahead.  A timing model that was already there is chained behind it.
+static cycles_t pyrite_operate(conf_object_t *mem_hier, conf_object_t *space,
+                               map_list_t *map_list, generic_transaction_t *mem_op){
+  pyrite_object_t *pyrite = (pyrite_object_t *) mem_hier;
+
+  if (g_functional_warming && SIM_mem_op_is_from_cpu(mem_op)) {
+    Processor *proc = g_processors_vec[SIM_get_processor_number(mem_op->ini_ptr)];
+    if (SIM_mem_op_is_instruction(mem_op)) {
+      proc->warmInstructionFetch(mem_op->logical_address, mem_op->physical_address);
+      s_warmed_fetches++;
+    } else {
+      proc->warmDataAccess(mem_op->physical_address,
+                           SIM_mem_op_is_write(mem_op) ? REQUEST_WRITE : REQUEST_READ);
+      s_warmed_accesses++;
+    }
+    // see every access, not only those that miss in the Simics STC
+    mem_op->block_STC = 1;
+  }
+
+  if (pyrite->next_timing_model != NULL) {
+    return pyrite->next_timing_iface.operate(pyrite->next_timing_model, space, map_list, mem_op);
+  }
+  return 0;
+}
+
+static conf_object_t *physical_memory(int processor_number){
+  attr_value_t attr = SIM_get_attribute(SIM_get_processor(processor_number), "physical_memory");
+  assert(attr.kind == Sim_Val_Object);
+  return attr.u.object;
+}
+
+static void start_functional_warming(pyrite_object_t *pyrite){
+  for (int i = 0; i < SIM_number_processors(); i++) {
+    conf_object_t *space = physical_memory(i);
+    attr_value_t current = SIM_get_attribute(space, "timing_model");
+    if ((current.kind == Sim_Val_Object) && (current.u.object != &pyrite->obj)) {
+      if ((pyrite->next_timing_model != NULL) && (pyrite->next_timing_model != current.u.object)) {
+        ERROR_MSG("Functional warming needs the same timing model on all memory spaces");
+      }
+      pyrite->next_timing_model = current.u.object;
+      pyrite->next_timing_iface = *(timing_model_interface_t *) SIM_get_interface(current.u.object, "timing_model");
+    }
+    attr_value_t self = SIM_make_attr_object(&pyrite->obj);
+    SIM_set_attribute(space, "timing_model", &self);
+    CHECK_SIM_EXCEPTION();
+    g_processors_vec[i]->resetWarming();
+  }
+  s_warmed_accesses = s_warmed_fetches = 0;
+  g_functional_warming = true;
+}
+
+static void stop_functional_warming(pyrite_object_t *pyrite, bool report){
+  if (!g_functional_warming) {
+    return;
+  }
+  g_functional_warming = false;
+
+  for (int i = 0; i < SIM_number_processors(); i++) {
+    attr_value_t previous = (pyrite->next_timing_model != NULL) ?
+      SIM_make_attr_object(pyrite->next_timing_model) : SIM_make_attr_nil();
+    SIM_set_attribute(physical_memory(i), "timing_model", &previous);
+    CHECK_SIM_EXCEPTION();
+  }
+  pyrite->next_timing_model = NULL;
+
+  if (!report) {
+    return;
+  }
+  printf("FUNCTIONAL WARMING: %lld data accesses, %lld instruction fetches\n",
+         (long long) s_warmed_accesses, (long long) s_warmed_fetches);
+  if ((s_warmed_fetches == 0) && (s_warmed_accesses != 0)) {
+    printf("No instruction fetches seen, branch predictors were not warmed (see instruction-fetch-mode)\n");
+  }
+}
+
 static set_error_t set_switch_to_warmup(void *dont_care, conf_object_t *obj, attr_value_t *val, attr_value_t *idx){
+  stop_functional_warming((pyrite_object_t *) obj, true);
   if (g_functional_only) {
     g_functional_only = false;
     SIM_break_cycle( SIM_current_processor(), 1 );
@@ -335,6 +634,7 @@ static set_error_t set_switch_to_warmup(void *dont_care, conf_object_t *obj, att
 }
 
 static set_error_t set_switch_to_timing(void *dont_care, conf_object_t *obj, attr_value_t *val, attr_value_t *idx){
+  stop_functional_warming((pyrite_object_t *) obj, true);
   if (g_functional_only) {
     g_functional_only = false;
     SIM_break_cycle( SIM_current_processor(), 1 );
@@ -356,12 +656,38 @@ static set_error_t set_switch_to_timing(void *dont_care, conf_object_t *obj, att
 }
 
 static set_error_t set_switch_to_functional(void *dont_care, conf_object_t *obj, attr_value_t *val, attr_value_t *idx){
+  stop_functional_warming((pyrite_object_t *) obj, true);
   printf("SWITCH TO FUNCTIONAL\n");
   g_functional_only = true;
   return Sim_Set_Ok;
 }
 
+static set_error_t set_switch_to_functional_warming(void *dont_care, conf_object_t *obj, attr_value_t *val, attr_value_t *idx){
+  if (!g_params.getPyriteIsControlling()){
+    g_params.setPyriteIsControlling(true);
+    init_processors();
+  }
+
+  printf("SWITCH TO FUNCTIONAL WARMING\n");
+  // nothing may be in flight while the committed state is trained
+  reset_processors();
+  start_functional_warming((pyrite_object_t *) obj);
+  g_functional_only = true;
+  return Sim_Set_Ok;
+}
+
+static set_error_t set_start_sampling(void *dont_care, conf_object_t *obj, attr_value_t *val, attr_value_t *idx){
+  start_sampling();
+  return Sim_Set_Ok;
+}
+
+static set_error_t set_stop_sampling(void *dont_care, conf_object_t *obj, attr_value_t *val, attr_value_t *idx){
+  stop_sampling(false);
+  return Sim_Set_Ok;
+}
+
 static set_error_t set_break_simulation(void *dont_care, conf_object_t *obj, attr_value_t *val, attr_value_t *idx){
+  stop_functional_warming((pyrite_object_t *) obj, true);
   if (g_functional_only) {
     g_functional_only = false;
     SIM_break_cycle( SIM_current_processor(), 1 );
@@ -371,6 +697,66 @@ static set_error_t set_break_simulation(void *dont_care, conf_object_t *obj, att
   return Sim_Set_Ok;
 }
 
+// Microarchitectural checkpoints go with a Simics checkpoint: the
+// value is [file, simics-checkpoint], and loading a file saved for a
+// different Simics checkpoint (or at a different cycle) is an error.
+static set_error_t set_save_checkpoint(void *dont_care, conf_object_t *obj, attr_value_t *val, attr_value_t *idx){
+  assert(idx->kind == Sim_Val_Nil);
+  assert(val->kind == Sim_Val_List && val->u.list.size == 2);
+  string filename = val->u.list.vector[0].u.string;
+  string key = val->u.list.vector[1].u.string;
+
+  CheckpointWriter cp;
+  if (!cp.open(filename, key)) {
+    printf("Unable to write checkpoint %s\n", filename.c_str());
+    return Sim_Set_Illegal_Value;
+  }
+  cp.beginSection("pyrite");
+  cp.write(g_processors_vec.size());
+  for (int i = 0; i < g_processors_vec.size(); i++) {
+    g_processors_vec[i]->checkpoint(cp);
+  }
+  cp.write(g_params.getRuby());
+  if (g_params.getRuby()) {
+    // only quiescent state is saved, so let everything in flight finish
+    g_eventQueue_ptr->triggerAllEvents();
+    g_system_ptr->checkpoint(cp);
+  }
+  cp.close();
+  printf("SAVED CHECKPOINT %s\n", filename.c_str());
+  return Sim_Set_Ok;
+}
+
+static set_error_t set_load_checkpoint(void *dont_care, conf_object_t *obj, attr_value_t *val, attr_value_t *idx){
+  assert(idx->kind == Sim_Val_Nil);
+  assert(val->kind == Sim_Val_List && val->u.list.size == 2);
+  string filename = val->u.list.vector[0].u.string;
+  string key = val->u.list.vector[1].u.string;
+
+  CheckpointReader cp;
+  if (!cp.open(filename, key)) {
+    printf("Unable to read checkpoint %s\n", filename.c_str());
+    return Sim_Set_Illegal_Value;
+  }
+  cp.beginSection("pyrite");
+  cp.check(g_processors_vec.size(), "number of processors");
+  for (int i = 0; i < g_processors_vec.size(); i++) {
+    g_processors_vec[i]->restore(cp);
+  }
+  bool ruby;
+  cp.read(ruby);
+  if (g_params.getRuby()) {
+    if (!ruby) {
+      ERROR_MSG("Checkpoint " + filename + " holds no Ruby state");
+    }
+    g_eventQueue_ptr->triggerAllEvents();
+    g_system_ptr->restore(cp);
+  }
+  cp.close();
+  printf("LOADED CHECKPOINT %s\n", filename.c_str());
+  return Sim_Set_Ok;
+}
+
 static unsigned g_marker_count = 0;
 
 const int OFFSET_SIZE = 4;
@@ -385,6 +771,7 @@ static conf_object_t * pyrite_new_instance(parse_object_t *pa){
   memset(&pyrite->next_timing_iface, 0, sizeof(pyrite->next_timing_iface));
   pyrite->trace_file = NULL;
   pyrite->trace_file_name = NULL;
+  s_pyrite = pyrite;
   
   return &pyrite->obj;
 
@@ -408,6 +795,12 @@ void init_local(void){
   myClass = SIM_register_class("pyrite", &class_data);
   CHECK_SIM_EXCEPTION();
 
+  /* pyrite is the memory hierarchy during functional warming */
+  timing_model_interface_t *timing_iface = MM_ZALLOC(1, timing_model_interface_t);
+  timing_iface->operate = pyrite_operate;
+  SIM_register_interface(myClass, "timing_model", timing_iface);
+  CHECK_SIM_EXCEPTION();
+
   /* initialize attributes */
   SIM_register_typed_attribute(myClass, "step_cycle",
                                NULL, NULL,
@@ -444,6 +837,27 @@ void init_local(void){
                                "i", NULL,
                                "");
   
+  SIM_register_typed_attribute(myClass, "switch_to_functional_warming",
+                               NULL, NULL,
+                               set_switch_to_functional_warming, NULL,
+                               Sim_Attr_Pseudo,
+                               "i", NULL,
+                               "run functionally, warming caches and predictors");
+  
+  SIM_register_typed_attribute(myClass, "start_sampling",
+                               NULL, NULL,
+                               set_start_sampling, NULL,
+                               Sim_Attr_Pseudo,
+                               "i", NULL,
+                               "start sampled simulation (see the Sampling* parameters)");
+  
+  SIM_register_typed_attribute(myClass, "stop_sampling",
+                               NULL, NULL,
+                               set_stop_sampling, NULL,
+                               Sim_Attr_Pseudo,
+                               "i", NULL,
+                               "stop sampled simulation and print the CPI estimate");
+  
   SIM_register_typed_attribute(myClass, "break_simulation",
                                NULL, NULL,
                                set_break_simulation, NULL,
@@ -458,6 +872,20 @@ void init_local(void){
                                "i", NULL,
                                "");
 
+  SIM_register_typed_attribute(myClass, "save_checkpoint",
+                               NULL, NULL,
+                               set_save_checkpoint, NULL,
+                               Sim_Attr_Pseudo,
+                               "[ss]", NULL,
+                               "save caches, directories and predictors as [file, simics-checkpoint]");
+
+  SIM_register_typed_attribute(myClass, "load_checkpoint",
+                               NULL, NULL,
+                               set_load_checkpoint, NULL,
+                               Sim_Attr_Pseudo,
+                               "[ss]", NULL,
+                               "restore caches, directories and predictors from [file, simics-checkpoint]");
+
   SIM_register_typed_attribute(myClass, "print_state",
                                NULL, NULL,
                                set_print_parameter, NULL,
@@ -470,4 +898,6 @@ void init_local(void){
 #include "params_attributes.inc"
 }
 
-DLL_EXPORT void fini_local(void){ }
+DLL_EXPORT void fini_local(void){
+  close_interval_stats(NULL, NULL);
+}
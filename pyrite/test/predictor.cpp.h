@@ -0,0 +1,455 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+//===-- predictor.cpp.h - branch predictor tests -----------------*- C++ -*--=//
+//
+//! Checks the ordering invariants of SquashableRing (save in program
+//! order, commit oldest first, squash youngest first, QPointers reused
+//! after a flush), that the predictors built on it repair their
+//! speculative state after a squash, and that a checkpoint of trained
+//! predictors and a BTB restores into fresh ones that then predict
+//! exactly as the originals.  Run by test/predictor-test.
+//
+//===----------------------------------------------------------------------===//
+
+#include <map>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Predictor.h"
+#include "TagePredictor.h"
+#include "PerceptronPredictor.h"
+#include "BranchTargetBuffer.h"
+#include "Checkpoint.h"
+
+#include "cxxtest/TestSuite.h"
+
+/* WARNING: DO NOT edit predictor.cpp directly. Instead, edit predictor.cpp.h. */
+
+//! the checkpoint code links against these Ruby globals
+class Param;
+Param* g_param_ptr = NULL;
+void pre_abort() {}
+
+static const unsigned WINDOW_SIZE = 16;
+static const char *CHECKPOINT_FILE = "predictor-test.ckpt";
+
+//! the predictors PredictorSet::PredictorSet builds by default
+struct GshareSet {
+  GshareSet()
+    : m_direct(8, 12, WINDOW_SIZE), m_indirect(8, WINDOW_SIZE), m_ras(32, WINDOW_SIZE),
+      m_btb(256, 4), m_set(&m_direct, &m_indirect, &m_ras, &m_btb) {}
+  GsharePredictor m_direct;
+  SimpleIndirectPredictor m_indirect;
+  ReturnAddressStack m_ras;
+  BranchTargetBuffer m_btb;
+  PredictorSet m_set;
+};
+
+class PredictorTestSuite : public CxxTest::TestSuite {
+private:
+  static Waddr branchRIP(QPointer q) { return 0x400000 + (q % 37) * 16; }
+
+  //! a branch pattern with some history correlation and a loop
+  static bool outcome(QPointer q) { return ((q % 7) != 6) ^ ((q / 3) & 1); }
+
+  static Waddr indirectTarget(QPointer q) { return 0x500000 + ((q / 2) % 5) * 64; }
+
+  //! the direction predicted for q must not depend on a wrong-path
+  //! excursion that was squashed before q was fetched.  Branches commit
+  //! commit_lag branches after they are fetched, so with a lag of 0 the
+  //! squash falls back to the committed state.
+  void checkWrongPathRepair(DirectPredictor &a, DirectPredictor &b, QPointer commit_lag) {
+    for (QPointer q = 1; q < 2000; q++) {
+      if ((q % 50) == 0) {
+        for (QPointer w = q; w < q + 8; w++) {
+          a.predict(branchRIP(w * 5), w);
+        }
+        a.squash(q);
+      }
+      bool pa = a.predict(branchRIP(q), q);
+      bool pb = b.predict(branchRIP(q), q);
+      TS_ASSERT_EQUALS(pa, pb);
+      if (pa != outcome(q)) {
+        a.resolve(q, outcome(q));
+        a.squash(q + 1);
+      }
+      if (pb != outcome(q)) {
+        b.resolve(q, outcome(q));
+        b.squash(q + 1);
+      }
+      if (q > commit_lag) {
+        a.commit(q - commit_lag);
+        b.commit(q - commit_lag);
+      }
+    }
+  }
+
+  //! as checkWrongPathRepair, for targets; the wrong path resolves too
+  void checkWrongPathRepair(IndirectPredictor &a, IndirectPredictor &b, QPointer commit_lag) {
+    for (QPointer q = 1; q < 2000; q++) {
+      if ((q % 50) == 0) {
+        for (QPointer w = q; w < q + 4; w++) {
+          a.predict(branchRIP(w * 3), w);
+          a.resolve(w, 0x123450 + w * 64);
+        }
+        a.squash(q);
+      }
+      Waddr pa = a.predict(branchRIP(q), q);
+      Waddr pb = b.predict(branchRIP(q), q);
+      TS_ASSERT_EQUALS(pa, pb);
+      a.resolve(q, indirectTarget(q));
+      b.resolve(q, indirectTarget(q));
+      if (pa != indirectTarget(q)) {
+        a.squash(q + 1);
+        b.squash(q + 1);
+      }
+      if (q > commit_lag) {
+        a.commit(q - commit_lag);
+        b.commit(q - commit_lag);
+      }
+    }
+  }
+
+  //! a resolve the pipeline does not flush for must leave the younger
+  //! branches in flight, and they must still resolve and commit
+  void checkResolveKeepsYounger(DirectPredictor &pred) {
+    bool predicted[8];
+    for (QPointer q = 1; q < 8; q++) {
+      predicted[q] = pred.predict(branchRIP(q), q);
+    }
+    pred.resolve(2, !predicted[2]);
+    for (QPointer q = 1; q < 8; q++) {
+      pred.resolve(q, (q == 2) ? !predicted[2] : predicted[q]);
+      pred.commit(q);
+    }
+    pred.predict(branchRIP(8), 8);
+    pred.commit(8);
+  }
+
+  //! calls and returns nested at most 6 deep, the same on both stacks
+  static void callOrReturn(ReturnAddressStack &ras, QPointer q, int &depth, Waddr &popped) {
+    if ((depth == 0) || ((depth < 6) && ((q * 7) % 11 < 5))) {
+      ras.push(q, 0x600000 + q * 4);
+      ++ depth;
+      popped = 0;
+    } else {
+      popped = ras.pop(q);
+      -- depth;
+    }
+  }
+
+  //! functional warming with conditional branches, indirect jumps,
+  //! calls and returns
+  static void warmSet(PredictorSet &set, QPointer count) {
+    for (QPointer q = 0; q < count; q++) {
+      Waddr rip = branchRIP(q);
+      Waddr fallthrough = rip + 2;
+      switch (q % 4) {
+      case 0:
+      case 1:
+        set.warm(rip, PTYPE_COND, false, fallthrough, outcome(q) ? rip + 0x40 : fallthrough);
+        break;
+      case 2:
+        set.warm(rip, PTYPE_INDIRECT, true, fallthrough, indirectTarget(q));
+        break;
+      default:
+        set.warm(rip, PTYPE_RAS, false, fallthrough, rip - 0x100);
+        break;
+      }
+    }
+  }
+
+  static void saveCheckpoint(const PredictorSet &set) {
+    CheckpointWriter writer;
+    TS_ASSERT(writer.open(CHECKPOINT_FILE, "predictor-test"));
+    set.checkpoint(writer);
+    writer.close();
+  }
+
+  static void loadCheckpoint(PredictorSet &set) {
+    CheckpointReader reader;
+    TS_ASSERT(reader.open(CHECKPOINT_FILE, "predictor-test"));
+    set.restore(reader);
+    reader.close();
+    remove(CHECKPOINT_FILE);
+  }
+
+  //! run the same branches, with mispredict recovery, through both
+  //! sets of predictors and compare every prediction
+  void checkSamePredictions(GshareSet &a, GshareSet &b) {
+    for (QPointer q = 1; q < 2000; q++) {
+      Waddr rip = branchRIP(q);
+      TS_ASSERT_EQUALS(a.m_btb.lookup(rip), b.m_btb.lookup(rip));
+      if ((q % 3) == 0) {
+        Waddr pa = a.m_indirect.predict(rip, q);
+        TS_ASSERT_EQUALS(pa, b.m_indirect.predict(rip, q));
+        a.m_indirect.resolve(q, indirectTarget(q));
+        b.m_indirect.resolve(q, indirectTarget(q));
+        a.m_indirect.commit(q);
+        b.m_indirect.commit(q);
+      } else if ((q % 5) == 0) {
+        if ((q % 2) == 0) {
+          TS_ASSERT_EQUALS(a.m_ras.pop(q), b.m_ras.pop(q));
+        } else {
+          a.m_ras.push(q, rip + 2);
+          b.m_ras.push(q, rip + 2);
+        }
+        a.m_ras.commit(q);
+        b.m_ras.commit(q);
+      } else {
+        bool pa = a.m_direct.predict(rip, q);
+        TS_ASSERT_EQUALS(pa, b.m_direct.predict(rip, q));
+        if (pa != outcome(q)) {
+          a.m_direct.resolve(q, outcome(q));
+          b.m_direct.resolve(q, outcome(q));
+        }
+        a.m_direct.commit(q);
+        b.m_direct.commit(q);
+      }
+    }
+  }
+
+public:
+  void testRingChain() {
+    SquashableRing<int> ring(8);
+    TS_ASSERT(ring.empty());
+    ring.save(1) = 10;
+    ring.save(3) = 30;
+    ring.save(4) = 40;
+    TS_ASSERT_EQUALS(ring.size(), 3u);
+    TS_ASSERT_EQUALS(ring.youngestQPointer(), (QPointer) 4);
+    TS_ASSERT_EQUALS(ring.youngest(), 40);
+
+    // saving the youngest again updates it in place
+    ring.save(4) = 41;
+    TS_ASSERT_EQUALS(ring.size(), 3u);
+    TS_ASSERT_EQUALS(ring.get(4), 41);
+
+    ring.squash(4);
+    TS_ASSERT_EQUALS(ring.size(), 2u);
+    TS_ASSERT(!ring.contains(4));
+    TS_ASSERT_EQUALS(ring.youngestQPointer(), (QPointer) 3);
+    TS_ASSERT_EQUALS(ring.youngest(), 30);
+
+    ring.commit(1);
+    TS_ASSERT_EQUALS(ring.size(), 1u);
+    TS_ASSERT(!ring.contains(1));
+    TS_ASSERT(ring.contains(3));
+
+    // the oldest is found again after a squash and a save
+    ring.save(5) = 50;
+    ring.commit(3);
+    ring.commit(5);
+    TS_ASSERT(ring.empty());
+
+    ring.save(6) = 60;
+    ring.clear();
+    TS_ASSERT(ring.empty());
+  }
+
+  void testRingReuseAfterFlush() {
+    SquashableRing<int> ring(8);
+    for (QPointer q = 1; q < 7; q++) {
+      ring.save(q) = q;
+    }
+    ring.squash(2);
+    TS_ASSERT_EQUALS(ring.size(), 1u);
+    TS_ASSERT_EQUALS(ring.youngestQPointer(), (QPointer) 1);
+
+    // refetch down the right path with the same QPointers
+    ring.save(2) = 200;
+    ring.save(3) = 300;
+    TS_ASSERT_EQUALS(ring.size(), 3u);
+    TS_ASSERT_EQUALS(ring.get(2), 200);
+    TS_ASSERT_EQUALS(ring.youngest(), 300);
+    for (QPointer q = 1; q < 4; q++) {
+      ring.commit(q);
+    }
+    TS_ASSERT(ring.empty());
+
+    // wrap around the slots
+    for (QPointer q = 9; q < 16; q++) {
+      ring.save(q) = q;
+    }
+    TS_ASSERT_EQUALS(ring.size(), 7u);
+    TS_ASSERT_EQUALS(ring.get(9), 9);
+    TS_ASSERT_EQUALS(ring.youngestQPointer(), (QPointer) 15);
+  }
+
+  //! random save/commit/squash sequences against a std::map
+  void testRingAgainstReference() {
+    SquashableRing<int> ring(WINDOW_SIZE);
+    std::map<QPointer, int> reference;
+    QPointer next = 0;
+    srand(1);
+    for (int i = 0; i < 200000; i++) {
+      int op = rand() % 8;
+      if ((op < 4) && (reference.empty() || (next - reference.begin()->first < WINDOW_SIZE))) {
+        ring.save(next) = i;
+        reference[next] = i;
+        next += 1 + rand() % 2;
+      } else if ((op < 6) && !reference.empty()) {
+        TS_ASSERT_EQUALS(ring.get(reference.begin()->first), reference.begin()->second);
+        ring.commit(reference.begin()->first);
+        reference.erase(reference.begin());
+      } else if (!reference.empty()) {
+        QPointer first_bad = reference.begin()->first + rand() % (next - reference.begin()->first + 1);
+        ring.squash(first_bad);
+        reference.erase(reference.lower_bound(first_bad), reference.end());
+        next = first_bad;
+      }
+      TS_ASSERT_EQUALS(ring.size(), (unsigned) reference.size());
+      if (!reference.empty()) {
+        TS_ASSERT_EQUALS(ring.youngestQPointer(), reference.rbegin()->first);
+        TS_ASSERT_EQUALS(ring.youngest(), reference.rbegin()->second);
+      }
+    }
+  }
+
+  void testGshareWrongPathRepair() {
+    GsharePredictor a(8, 12, WINDOW_SIZE), b(8, 12, WINDOW_SIZE);
+    checkWrongPathRepair(a, b, 4);
+  }
+
+  void testGshareSquashToCommitted() {
+    GsharePredictor a(8, 12, WINDOW_SIZE), b(8, 12, WINDOW_SIZE);
+    checkWrongPathRepair(a, b, 0);
+  }
+
+  void testGshareResolveKeepsYounger() {
+    GsharePredictor pred(8, 12, WINDOW_SIZE);
+    checkResolveKeepsYounger(pred);
+  }
+
+  void testSimpleIndirectWrongPathRepair() {
+    SimpleIndirectPredictor a(8, WINDOW_SIZE), b(8, WINDOW_SIZE);
+    checkWrongPathRepair(a, b, 4);
+  }
+
+  void testTageWrongPathRepair() {
+    TageScLPredictor a(WINDOW_SIZE), b(WINDOW_SIZE);
+    checkWrongPathRepair(a, b, 4);
+  }
+
+  void testPerceptronWrongPathRepair() {
+    PerceptronPredictor a(WINDOW_SIZE), b(WINDOW_SIZE);
+    checkWrongPathRepair(a, b, 4);
+  }
+
+  void testTageResolveKeepsYounger() {
+    TageScLPredictor pred(WINDOW_SIZE);
+    checkResolveKeepsYounger(pred);
+  }
+
+  void testPerceptronResolveKeepsYounger() {
+    PerceptronPredictor pred(WINDOW_SIZE);
+    checkResolveKeepsYounger(pred);
+  }
+
+  void testIttageWrongPathRepair() {
+    IttagePredictor a(WINDOW_SIZE), b(WINDOW_SIZE);
+    checkWrongPathRepair(a, b, 4);
+  }
+
+  //! the stack pointers after a squash are those of the youngest
+  //! branch left in flight
+  void testRasWrongPathRepair() {
+    ReturnAddressStack a(32, WINDOW_SIZE), b(32, WINDOW_SIZE);
+    int depth_a = 0, depth_b = 0;
+    for (QPointer q = 1; q < 2000; q++) {
+      if ((q % 50) == 0) {
+        // a wrong path that returns past everything and calls again
+        for (QPointer w = q; w < q + 8; w++) {
+          if (w < q + 5) {
+            a.pop(w);
+          } else {
+            a.push(w, 0xbad000 + w);
+          }
+        }
+        a.squash(q);
+      }
+      Waddr popped_a, popped_b;
+      callOrReturn(a, q, depth_a, popped_a);
+      callOrReturn(b, q, depth_b, popped_b);
+      TS_ASSERT_EQUALS(popped_a, popped_b);
+      if (q > 4) {
+        a.commit(q - 4);
+        b.commit(q - 4);
+      }
+    }
+  }
+
+  //! with nothing left in flight a squash returns to the committed
+  //! stack pointers
+  void testRasSquashToCommitted() {
+    ReturnAddressStack ras(32, WINDOW_SIZE);
+    for (QPointer q = 1; q < 5; q++) {
+      ras.push(q, 0x600000 + q);
+    }
+    for (QPointer q = 1; q < 4; q++) {
+      ras.commit(q);
+    }
+    // a wrong path past the one branch still in flight
+    ras.pop(5);
+    ras.pop(6);
+    ras.push(7, 0xbad000);
+    ras.squash(4);
+    TS_ASSERT_EQUALS(ras.pop(20), (Waddr) 0x600003);
+    TS_ASSERT_EQUALS(ras.pop(21), (Waddr) 0x600002);
+    TS_ASSERT_EQUALS(ras.pop(22), (Waddr) 0x600001);
+    for (QPointer q = 20; q < 23; q++) {
+      ras.commit(q);
+    }
+  }
+
+  void testPredictorSetCheckpointRoundTrip() {
+    GshareSet trained, restored;
+    warmSet(trained.m_set, 5000);
+    saveCheckpoint(trained.m_set);
+    loadCheckpoint(restored.m_set);
+    checkSamePredictions(trained, restored);
+  }
+
+  void testBtbCheckpointRoundTrip() {
+    BranchTargetBuffer trained(64, 4), restored(64, 4);
+    srand(1);
+    for (int i = 0; i < 5000; i++) {
+      trained.insert(0x400000 + (rand() % 300) * 4);
+    }
+    CheckpointWriter writer;
+    TS_ASSERT(writer.open(CHECKPOINT_FILE, "predictor-test"));
+    trained.checkpoint(writer);
+    writer.close();
+    CheckpointReader reader;
+    TS_ASSERT(reader.open(CHECKPOINT_FILE, "predictor-test"));
+    restored.restore(reader);
+    reader.close();
+    remove(CHECKPOINT_FILE);
+
+    // the LRU order must survive too, so keep inserting into both
+    for (int i = 0; i < 5000; i++) {
+      Waddr rip = 0x400000 + (rand() % 300) * 4;
+      TS_ASSERT_EQUALS(trained.lookup(rip), restored.lookup(rip));
+      trained.insert(rip);
+      restored.insert(rip);
+    }
+  }
+};
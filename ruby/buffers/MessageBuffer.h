@@ -66,6 +66,7 @@
 #include "PrioHeap.h"
 #include "NodeID.h"
 #include "util.h"
+#include "Vector.h"
 
 class MessageBuffer {
 public:
@@ -92,6 +93,11 @@ public:
 
   Consumer* getConsumer() { return m_consumer_ptr; }
 
+  // Optional bit in a consumer-owned bitmap that is kept set while the
+  // buffer holds at least one message, so a consumer with many inputs
+  // can skip the empty ones without touching them.
+  void setOccupancyBit(Vector<uint64>* mask_ptr, int bit);
+
   const Message* peekAtHeadOfQueue() const;
   const Message* peek() const { return peekAtHeadOfQueue(); }
   const MsgPtr& peekMsgPtr() const { assert(isReady()); return m_prio_heap.peekMin().m_msgptr; }
@@ -115,6 +121,13 @@ public:
   void print(ostream& out) const;
 private:
   // Private Methods  
+  void setOccupied(bool occupied) {
+    if (m_occupancy_mask_ptr != NULL) {
+      uint64& word = (*m_occupancy_mask_ptr)[m_occupancy_bit >> 6];
+      uint64 bit = 1ULL << (m_occupancy_bit & 63);
+      word = occupied ? (word | bit) : (word & ~bit);
+    }
+  }
 
   // Private copy constructor and assignment operator
   MessageBuffer(const MessageBuffer& obj);
@@ -122,6 +135,8 @@ private:
 
   // Data Members (m_ prefix)
   Consumer* m_consumer_ptr;  // Consumer to signal a wakeup(), can be NULL
+  Vector<uint64>* m_occupancy_mask_ptr;  // Consumer's non-empty bitmap, can be NULL
+  int m_occupancy_bit;
   PrioHeap<MessageBufferNode> m_prio_heap;
   string m_name;
 
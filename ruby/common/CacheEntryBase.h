@@ -63,6 +63,8 @@
 
 class Address;
 class DataBlock;
+class CheckpointWriter;
+class CheckpointReader;
 
 class CacheEntryBase {
 public:
@@ -88,6 +90,9 @@ public:
   virtual const DataBlock& getDataBlk() const = 0;
   virtual DataBlock& getDataBlk() = 0;
 
+  virtual void checkpoint(CheckpointWriter& cp) const = 0;
+  virtual void restore(CheckpointReader& cp) = 0;
+
   virtual void print(ostream& out) const = 0;
 private:
   // Private Methods
@@ -61,6 +61,27 @@
 #include "Global.h"
 #include "Vector.h"
 
+// Ruby never needs data values for timing: pyrite reads them from
+// Simics.  Under NO_STORAGE (the default build) DataBlock is therefore
+// an empty type whose methods do nothing, so messages, TBEs and cache
+// and directory entries neither carry nor copy a line of data.  Build
+// with check_data=1 (no NO_STORAGE) to keep real data, e.g. for
+// protocol verification with the ruby tester.
+
+#ifdef NO_STORAGE
+
+class DataBlock {
+public:
+  // Public Methods
+  void clear() { }
+  uint8 getByte(int whichByte) const { return 0; }
+  void setByte(int whichByte, uint8 data) { }
+  bool equal(const DataBlock& obj) const { return true; }
+  void print(ostream& out) const { out << "[]"; }
+};
+
+#else
+
 class DataBlock {
 public:
   // Constructors
@@ -83,6 +104,8 @@ private:
   Vector<uint8> m_data;
 };
 
+#endif // NO_STORAGE
+
 // Output operator declaration
 ostream& operator<<(ostream& out, const DataBlock& obj);
 
@@ -0,0 +1,130 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+/*
+ * Description: A log-linear ("HDR") histogram.  Values below
+ * 2^m_sub_bucket_bits are counted exactly; above that each power of
+ * two is split into 2^(m_sub_bucket_bits-1) equal sub-buckets, so
+ * every recorded value is accurate to the requested number of
+ * significant decimal digits no matter how large it gets.  The bucket
+ * of a sample is found with a count-leading-zeros and a shift.
+ *
+ * Histograms with the same precision can be merged, e.g. to combine
+ * per-processor histograms, and answer percentile queries.
+ */
+
+#ifndef HDRHISTOGRAM_H
+#define HDRHISTOGRAM_H
+
+#include "Global.h"
+#include "Vector.h"
+
+class HdrHistogram {
+public:
+  // Constructors
+  HdrHistogram(int significant_digits = 2);
+
+  // Destructor
+  ~HdrHistogram();
+
+  // Public Methods
+
+  void add(int64 value) { addN(value, 1); }
+  void addN(int64 value, int64 count);
+  void merge(const HdrHistogram& other);
+  void clear();
+
+  int64 size() const { return m_count; }
+  int64 getTotal() const { return m_sumSamples; }
+  int64 getMin() const { return (m_count == 0) ? 0 : m_min; }
+  int64 getMax() const { return m_max; }
+  double getAverage() const { return (m_count == 0) ? 0.0 : double(m_sumSamples)/m_count; }
+  int getSignificantDigits() const { return m_significant_digits; }
+
+  // Smallest recorded value (within the histogram's precision) that
+  // is greater than or equal to percentile% of all samples
+  int64 getPercentile(double percentile) const;
+
+  // Walk the non-empty buckets: for (i = 0; i < getNumBuckets(); i++)
+  int getNumBuckets() const { return m_data.size(); }
+  int64 getBucketCount(int index) const { return m_data[index]; }
+  int64 getBucketLow(int index) const;
+  int64 getBucketHigh(int index) const;
+
+  void print(ostream& out) const;
+  int64 getMemoryUsage() const { return m_data.getMemoryUsage(); }
+private:
+  // Private Methods
+  int getIndex(int64 value) const;
+
+  // Data Members (m_ prefix)
+  Vector<int64> m_data;       // grown on demand up to the largest bucket used
+  int m_significant_digits;
+  int m_sub_bucket_bits;      // log2 of the number of exactly counted values
+  int64 m_count;              // the number of elements added
+  int64 m_min;                // the minimum value seen so far
+  int64 m_max;                // the maximum value seen so far
+  int64 m_sumSamples;         // the sum of all samples
+};
+
+// Output operator declaration
+ostream& operator<<(ostream& out, const HdrHistogram& obj);
+
+// ******************* Definitions *******************
+
+inline
+int HdrHistogram::getIndex(int64 value) const
+{
+  // Values below 2^m_sub_bucket_bits land in "exponent" 0; or-ing in
+  // the mask keeps the clz from ever seeing a smaller value
+  uint64 mask = (1ULL << m_sub_bucket_bits) - 1;
+  int exponent = (63 - __builtin_clzll(uint64(value) | mask)) - (m_sub_bucket_bits - 1);
+  return (exponent << (m_sub_bucket_bits - 1)) + int(uint64(value) >> exponent);
+}
+
+inline
+void HdrHistogram::addN(int64 value, int64 count)
+{
+  assert(value >= 0);
+  int index = getIndex(value);
+  if (index >= m_data.size()) {
+    m_data.increaseSize(index + 1, 0);
+  }
+  m_data[index] += count;
+  m_count += count;
+  m_sumSamples += value * count;
+  if (value > m_max) {
+    m_max = value;
+  }
+  if (value < m_min) {
+    m_min = value;
+  }
+}
+
+// Output operator definition
+extern inline
+ostream& operator<<(ostream& out, const HdrHistogram& obj)
+{
+  obj.print(out);
+  out << flush;
+  return out;
+}
+
+#endif //HDRHISTOGRAM_H
@@ -85,6 +85,7 @@ public:
   void printWithMultiplier(ostream& out, double multiplier) const;
   void printPercent(ostream& out) const;
   void print(ostream& out) const;
+  int64 getMemoryUsage() const { return m_data.getMemoryUsage(); }
 private:
   // Private Methods
 
@@ -56,6 +56,10 @@
 // -----------------------------------------------------------------------------
 
 // NetDest specifies the network destination of a NetworkMessage.
+//
+// All (MachineType, NodeID) pairs are packed into one flat bit vector,
+// bit (machine * NUM_NODES + node), so that the operations the network
+// performs on every message are short word loops.
 
 #ifndef NETDEST_H
 #define NETDEST_H
@@ -105,13 +109,37 @@ public:
   // Returns true if the intersection of the two netDests is empty
   bool intersectionIsEmpty(const NetDest& other_netDest) const;
 
+  bool isEmpty() const;
+  bool isEqual(const NetDest& other) const {
+    for (int i = 0; i < m_num_words; i++) {
+      if (m_bits[i] != other.m_bits[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Access by flat index (machine * NUM_NODES + node), used by the
+  // network to precompute per-destination routing
+  int getNumBits() const { return MachineType_NUM * m_num_nodes; }
+  bool isElementIndex(int index) const { return ((m_bits[index / SET_BITS_PER_WORD] >> (index % SET_BITS_PER_WORD)) & 1) != 0; }
+  void addIndex(int index) { m_bits[index / SET_BITS_PER_WORD] |= (1ULL << (index % SET_BITS_PER_WORD)); }
+  int smallestIndex() const;  // -1 if empty
+
+  // raw access to the flat layout
+  int getNumWords() const { return m_num_words; }
+  uint64 getWord(int index) const { return m_bits[index]; }
+
   void print(ostream& out) const;
 private:
 
   // Private Methods
-  
+  int flatIndex(MachineType machine, NodeID node) const { return int(machine) * m_num_nodes + node; }
+
   // Data Members (m_ prefix)
-  Vector<Set> m_sets;  // a Vector of bit vectors - i.e. Sets
+  int m_num_nodes;  // bits per machine type
+  int m_num_words;  // number of words of m_bits in use
+  uint64 m_bits[(MachineType_NUM * SET_MAX_NODES + SET_BITS_PER_WORD - 1) / SET_BITS_PER_WORD];
 };
 
 // Output operator declaration
@@ -128,5 +156,41 @@ ostream& operator<<(ostream& out, const NetDest& obj)
   return out;
 }
 
+inline
+bool NetDest::isElement(MachineType machine, NodeID element) const
+{
+  return isElementIndex(flatIndex(machine, element));
+}
+
+inline
+int NetDest::smallestIndex() const
+{
+  for (int i = 0; i < m_num_words; i++) {
+    if (m_bits[i] != 0) {
+      return i * SET_BITS_PER_WORD + __builtin_ctzll(m_bits[i]);
+    }
+  }
+  return -1;
+}
+
+// Returns true if the intersection of the two sets is non-empty
+inline
+bool NetDest::intersectionIsNotEmpty(const NetDest& other_netDest) const
+{
+  assert(m_num_words == other_netDest.m_num_words);
+  uint64 common = 0;
+  for (int i = 0; i < m_num_words; i++) {
+    common |= (m_bits[i] & other_netDest.m_bits[i]);
+  }
+  return (common != 0);
+}
+
+// Returns true if the intersection of the two sets is empty
+inline
+bool NetDest::intersectionIsEmpty(const NetDest& other_netDest) const
+{
+  return !intersectionIsNotEmpty(other_netDest);
+}
+
 #endif //NETDEST_H
 
@@ -55,6 +55,11 @@
 //
 // -----------------------------------------------------------------------------
 
+// Set is a fixed-capacity bit vector of NodeIDs.  The storage is an
+// inline array of 64-bit words sized for SET_MAX_NODES, but every
+// operation only walks the m_num_words words that NUM_NODES actually
+// uses, so small configurations still do single-word operations.
+
 #ifndef SET_H
 #define SET_H
 
@@ -62,6 +67,15 @@
 #include "Vector.h"
 #include "NodeID.h"
 
+// Upper bound on the number of nodes; override with -DSET_MAX_NODES=n
+// (see the max_nodes scons option)
+#ifndef SET_MAX_NODES
+#define SET_MAX_NODES 256
+#endif
+
+const int SET_BITS_PER_WORD = 64;
+const int SET_MAX_WORDS = (SET_MAX_NODES + SET_BITS_PER_WORD - 1) / SET_BITS_PER_WORD;
+
 class Set {
 public:
   // Constructors
@@ -104,16 +118,21 @@ public:
   NodeID smallestElement() const;
   int getSize() const { return m_size; }
 
+  // raw word access, used by NetDest to pack sets into its flat layout
+  int getNumWords() const { return m_num_words; }
+  uint64 getWord(int index) const { return m_bits[index]; }
+
   void print(ostream& out) const;
 private:
   // Private Methods
   void setSize (int size);
   Set(int size);
+  uint64 lastWordMask() const;  // the valid bits of the last word in use
 
   // Data Members (m_ prefix)
   int m_size;
-  uint32 m_bits;  // Set as a bit vector
-  uint32 m_mask;  // a 000001111 mask where the number of 1s is equal to m_size
+  int m_num_words;  // number of words of m_bits in use
+  uint64 m_bits[SET_MAX_WORDS];  // Set as a bit vector
 };
 
 // Output operator declaration
@@ -130,4 +149,29 @@ ostream& operator<<(ostream& out, const Set& obj)
   return out;
 }
 
-#endif //BIGSET
+inline
+bool Set::isElement(NodeID element) const
+{
+  return ((m_bits[element / SET_BITS_PER_WORD] >> (element % SET_BITS_PER_WORD)) & 1) != 0;
+}
+
+// Returns true if the intersection of the two sets is non-empty
+inline
+bool Set::intersectionIsNotEmpty(const Set& other_set) const
+{
+  assert(m_size == other_set.m_size);
+  uint64 common = 0;
+  for (int i = 0; i < m_num_words; i++) {
+    common |= (m_bits[i] & other_set.m_bits[i]);
+  }
+  return (common != 0);
+}
+
+// Returns true if the intersection of the two sets is empty
+inline
+bool Set::intersectionIsEmpty(const Set& other_set) const
+{
+  return !intersectionIsNotEmpty(other_set);
+}
+
+#endif //SET_H
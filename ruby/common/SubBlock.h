@@ -66,7 +66,7 @@
 class SubBlock {
 public:
   // Constructors
-  SubBlock() { } 
+  SubBlock() { setSize(0); } 
   SubBlock(const Address& addr, int size);
 
   // Destructor
@@ -76,10 +76,18 @@ public:
   const Address& getAddress() const { return m_address; }
   void setAddress(const Address& addr) { m_address = addr; }
 
+#ifdef NO_STORAGE
+  // No data is kept, see DataBlock.h
+  int getSize() const { return m_size; }
+  void setSize(int size) { m_size = size; }
+  uint8 getByte(int offset) const { return 0; }
+  void setByte(int offset, uint8 data) { }
+#else
   int getSize() const { return m_data.size(); }
   void setSize(int size) {  m_data.setSize(size); }
   uint8 getByte(int offset) const { return m_data[offset]; }
   void setByte(int offset, uint8 data) { m_data[offset] = data; }
+#endif
 
   // Shorthands
   uint8 readByte() const { return getByte(0); }
@@ -100,7 +108,11 @@ private:
 
   // Data Members (m_ prefix)
   Address m_address;
+#ifdef NO_STORAGE
+  int m_size;
+#else
   Vector<uint8> m_data;
+#endif
 };
 
 // Output operator declaration
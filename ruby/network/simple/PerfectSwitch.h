@@ -109,6 +109,14 @@ private:
   // Private copy constructor and assignment operator
   PerfectSwitch(const PerfectSwitch& obj);
   PerfectSwitch& operator=(const PerfectSwitch& obj);
+
+  // Private Methods
+  void routeByTable(const NetDest& msg_destinations, Vector<LinkID>& output_links, Vector<NetDest>& output_link_destinations) const;
+  void routeByScan(NetDest msg_destinations, int vnet, Vector<LinkID>& output_links, Vector<NetDest>& output_link_destinations);
+  bool isInputOccupied(int port, int vnet) const {
+    int bit = port * m_virtual_networks + vnet;
+    return (m_occupied_inputs[bit >> 6] >> (bit & 63)) & 1;
+  }
   
   // Data Members (m_ prefix)
   SwitchID m_switch_id;
@@ -118,6 +126,17 @@ private:
   Vector<Vector<MessageBuffer*> > m_out;
   Vector<NetDest> m_routing_table;
   Vector<LinkOrder> m_link_order;
+
+  // Precomputed as links are added: the first link (in routing table
+  // order) that reaches each destination, indexed by NetDest flat
+  // index, and for each link the destinations it is first for.  These
+  // give the same answer as scanning m_routing_table in order.
+  Vector<LinkID> m_dest_to_link;
+  Vector<NetDest> m_link_owned_dests;
+
+  // One bit per input buffer (bit port * m_virtual_networks + vnet),
+  // set by the buffer itself while it holds any message
+  Vector<uint64> m_occupied_inputs;
   int m_virtual_networks;
   int m_round_robin_start;
   SimpleNetwork* m_network_ptr;
@@ -104,6 +104,8 @@ private:
   void addVirtualNetwork(MessageBuffer* in_ptr, MessageBuffer* out_ptr);
   int getLinkBandwidth() const;
   void linkUtilized(double ratio) { m_links_utilized += ratio; }
+  void scheduleNextWakeup();
+  void catchUpDrainedCycles();
 
   // Private copy constructor and assignment operator
   Throttle(const Throttle& obj);
@@ -124,6 +126,13 @@ private:
   int m_link_bandwidth_multiplier;
   int m_link_latency;
 
+  // When a single large message is all that is left to move, the
+  // cycles it spends only draining bandwidth are skipped and accounted
+  // for in bulk: m_drain_vnet is its vnet (-1 if none) and m_drain_start
+  // the cycle the skip was scheduled from.
+  int m_drain_vnet;
+  Time m_drain_start;
+
   // For tracking utilization
   Time m_ruby_start;
   double m_links_utilized;
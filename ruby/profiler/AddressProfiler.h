@@ -65,9 +65,8 @@
 #include "CacheMsg.h"
 #include "AccessType.h"
 
-class AccessTraceForAddress;
+class HotAddressTable;
 class Set;
-template <class KEY_TYPE, class VALUE_TYPE> class Map;
 
 class AddressProfiler {
 public:
@@ -87,6 +86,7 @@ public:
   void profileGetS(const Address& datablock, const Address& PC, const Set& owner, const Set& sharers, NodeID requestor);
 
   void print(ostream& out) const;
+  int64 getMemoryUsage() const;
 private:
   // Private Methods
 
@@ -97,10 +97,10 @@ private:
   // Data Members (m_ prefix)
   int64 m_sharing_miss_counter;
 
-  Map<Address, AccessTraceForAddress>* m_dataAccessTrace;
-  Map<Address, AccessTraceForAddress>* m_macroBlockAccessTrace;
-  Map<Address, AccessTraceForAddress>* m_programCounterAccessTrace;
-  Map<Address, AccessTraceForAddress>* m_retryProfileMap;
+  HotAddressTable* m_dataAccessTrace;
+  HotAddressTable* m_macroBlockAccessTrace;
+  HotAddressTable* m_programCounterAccessTrace;
+  HotAddressTable* m_retryProfileMap;
   Histogram m_retryProfileHisto;
   Histogram m_retryProfileHistoWrite;
   Histogram m_retryProfileHistoRead;
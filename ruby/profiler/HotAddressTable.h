@@ -0,0 +1,107 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+// Per-address access records for AddressProfiler.  Unbounded, every
+// address gets an exact record.  Bounded to max_entries records, the
+// table runs the Space-Saving algorithm: when a new address arrives and
+// the table is full it takes over the record with the smallest count,
+// inheriting that count as its error.  With N samples in total:
+//   - every address seen more than N / max_entries times is present
+//   - getRecord(i).getTotal() counts what was seen since the address
+//     was (last) admitted, a lower bound on its true count
+//   - getRecord(i).getTotal() + getError(i) is an upper bound
+//   - no address that is not present was seen more than getMaxError()
+//     times
+
+#ifndef HOTADDRESSTABLE_H
+#define HOTADDRESSTABLE_H
+
+#include "Global.h"
+#include "Address.h"
+#include "Vector.h"
+#include "Map.h"
+#include "CacheRequestType.h"
+#include "AccessModeType.h"
+#include "NodeID.h"
+
+class AccessTraceForAddress;
+
+class HotAddressTable {
+public:
+  // Constructors
+  // max_entries == 0 keeps a record for every address
+  explicit HotAddressTable(int max_entries);
+
+  // Destructor
+  ~HotAddressTable();
+
+  // Public Methods
+  void update(const Address& addr, CacheRequestType type, AccessModeType access_mode, NodeID cpu, bool sharing_miss);
+  void addSample(const Address& addr, int value);
+  void clear();
+
+  bool isBounded() const { return m_max_entries > 0; }
+  int getMaxEntries() const { return m_max_entries; }
+  int size() const { return m_records.size(); }
+  const AccessTraceForAddress& getRecord(int index) const { return *m_records[index]; }
+  uint64 getError(int index) const { return m_errors[index]; }
+  uint64 getMaxError() const;
+  uint64 getEvictions() const { return m_evictions; }
+
+  void print(ostream& out) const;
+  // bytes of the records and the tables indexing them
+  int64 getMemoryUsage() const;
+private:
+  // Private Methods
+  int lookupSlot(const Address& addr);
+  uint64 estimate(int slot) const;
+  void increased(int slot);
+  void heapSwap(int i, int j);
+
+  // Private copy constructor and assignment operator
+  HotAddressTable(const HotAddressTable& obj);
+  HotAddressTable& operator=(const HotAddressTable& obj);
+
+  // Data Members (m_ prefix)
+  int m_max_entries;
+  Map<Address, int> m_slot_map;  // address -> index in m_records
+  Vector<AccessTraceForAddress*> m_records;
+  Vector<uint64> m_errors;
+  uint64 m_evictions;
+
+  // Bounded mode only: min-heap of slots ordered by estimate()
+  Vector<int> m_heap;
+  Vector<int> m_heap_pos;  // slot -> index in m_heap
+};
+
+// Output operator declaration
+ostream& operator<<(ostream& out, const HotAddressTable& obj);
+
+// ******************* Definitions *******************
+
+// Output operator definition
+extern inline 
+ostream& operator<<(ostream& out, const HotAddressTable& obj)
+{
+  obj.print(out);
+  out << flush;
+  return out;
+}
+
+#endif //HOTADDRESSTABLE_H
@@ -61,6 +61,7 @@
 #include "Global.h"
 #include "MachineType.h"
 #include "Histogram.h"
+#include "HdrHistogram.h"
 #include "Consumer.h"
 #include "AccessModeType.h"
 #include "AccessType.h"
@@ -69,13 +70,14 @@
 #include "Address.h"
 #include "Set.h"
 #include "CacheRequestType.h"
+#include "HostMemory.h"
 
 class CacheMsg;
 class CacheProfiler;
 class AddressProfiler;
 template <class KEY_TYPE, class VALUE_TYPE> class Map;
 
-class Profiler : public Consumer {
+class Profiler : public Consumer, public HostMemoryReporter {
 public:
   // Constructors
   Profiler();
@@ -126,8 +128,13 @@ public:
 
   integer_t getNumL1Misses(NodeID id) { return m_perProcL1Misses[id]; }
   integer_t getNumL2Misses(NodeID id) { return m_perProcL2Misses[id]; }
+
+  void profileDramRequest(bool write) { if (write) { m_dram_writes++; } else { m_dram_reads++; } }
+  integer_t getNumDramReads() const { return m_dram_reads; }
+  integer_t getNumDramWrites() const { return m_dram_writes; }
  
   void print(ostream& out) const {}
+  void reportHostMemory() const;
   static Profiler* create() { return new Profiler; }
 private:
   // Private Methods
@@ -163,9 +170,11 @@ private:
   Histogram m_all_sharing_histogram;
   int64 m_cache_to_cache;
   int64 m_memory_to_cache;
+  integer_t m_dram_reads;
+  integer_t m_dram_writes;
 
-  Vector<Histogram> m_missLatencyHistograms;
-  Histogram m_allMissLatencyHistogram;
+  // one per request type, merged for the overall miss latency
+  Vector<HdrHistogram> m_missLatencyHistograms;
 
   Histogram m_gets_mask_prediction;
   Histogram m_getx_mask_prediction;
@@ -0,0 +1,180 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+/*
+ * Description: Compact binary cache request traces.  Records are
+ *              grouped into blocks of BINARY_TRACE_BLOCK_RECORDS;
+ *              inside a block every field is stored as a zigzag
+ *              varint delta from the previous record, and each block
+ *              is zlib-compressed on its own.  An index at the end of
+ *              the file lists every block with its time, address
+ *              range and the processors it contains, so a reader can
+ *              skip blocks that a replay filter rules out.
+ *
+ *              File layout (host byte order):
+ *                BinaryTraceHeader
+ *                compressed blocks, back to back
+ *                uint64 block count, then one BinaryTraceIndexEntry per block
+ *
+ *              The writer compresses and writes blocks on a helper
+ *              thread; the reader mmaps the file.
+ */
+
+#ifndef BINARYTRACE_H
+#define BINARYTRACE_H
+
+#include "Global.h"
+#include "Vector.h"
+#include "NodeID.h"
+#include "TraceRecord.h"
+#include <pthread.h>
+#include <stdio.h>
+
+const int BINARY_TRACE_BLOCK_RECORDS = 4096;
+const int BINARY_TRACE_MAX_PENDING_BLOCKS = 8;  // blocks queued for the compression thread
+const uint32 BINARY_TRACE_VERSION = 1;
+
+struct BinaryTraceHeader {
+  char m_magic[8];          // "RUBYTRC" plus a NUL
+  uint32 m_version;
+  uint32 m_block_records;
+  uint64 m_record_count;
+  uint64 m_index_offset;    // 0 until the writer has been closed
+};
+
+struct BinaryTraceIndexEntry {
+  uint64 m_offset;          // of the compressed block in the file
+  uint32 m_compressed_size;
+  uint32 m_raw_size;
+  uint32 m_records;
+  uint32 m_padding;
+  uint64 m_first_time;
+  uint64 m_min_address;     // data addresses
+  uint64 m_max_address;
+  uint64 m_node_mask;       // bit (node % 64) for every processor in the block
+};
+
+class BinaryTraceWriter {
+public:
+  // Constructors
+  BinaryTraceWriter();
+
+  // Destructor
+  ~BinaryTraceWriter();
+
+  // Public Methods
+  bool open(string filename);
+  void write(const TraceRecord& record);
+  void close();
+  bool isOpen() const { return m_file != NULL; }
+  int64 getRecordCount() const { return m_record_count; }
+
+  // Names ending in ".rbt" select the binary format
+  static bool isBinaryTraceName(const string& filename);
+
+  // Entry point of the compression thread
+  static void* compressionThread(void* writer);
+private:
+  // Private Methods
+  struct PendingBlock {
+    Vector<uint8> m_raw;
+    BinaryTraceIndexEntry m_entry;
+  };
+
+  void startBlock();
+  void flushBlock();
+  void compressLoop();
+
+  // Private copy constructor and assignment operator
+  BinaryTraceWriter(const BinaryTraceWriter& obj);
+  BinaryTraceWriter& operator=(const BinaryTraceWriter& obj);
+
+  // Data Members (m_ prefix)
+  FILE* m_file;
+  int64 m_record_count;
+
+  // the block being filled by write()
+  PendingBlock* m_block_ptr;
+  TraceRecord m_last_record;
+
+  // blocks waiting for the compression thread, a ring of pointers
+  PendingBlock* m_pending[BINARY_TRACE_MAX_PENDING_BLOCKS];
+  int m_pending_head;
+  int m_pending_count;
+  bool m_closing;
+  pthread_t m_thread;
+  pthread_mutex_t m_mutex;
+  pthread_cond_t m_not_empty;
+  pthread_cond_t m_not_full;
+
+  // only touched by the compression thread until it has been joined
+  Vector<BinaryTraceIndexEntry> m_index;
+  uint64 m_file_offset;
+};
+
+class BinaryTraceReader {
+public:
+  // Constructors
+  BinaryTraceReader();
+
+  // Destructor
+  ~BinaryTraceReader();
+
+  // Public Methods
+
+  // Replay only records of one processor (-1 for all) whose data
+  // address lies in [min_address, max_address]
+  bool open(string filename, NodeID node = -1, physical_address_t min_address = 0,
+            physical_address_t max_address = ~physical_address_t(0));
+  bool next(TraceRecord& record);
+  void close();
+  int64 getRecordCount() const { return m_header_ptr->m_record_count; }
+
+  // True if the file starts with the binary trace magic
+  static bool isBinaryTrace(const string& filename);
+private:
+  // Private Methods
+  bool loadBlock(int block);
+  bool matches(const TraceRecord& record) const;
+
+  // Private copy constructor and assignment operator
+  BinaryTraceReader(const BinaryTraceReader& obj);
+  BinaryTraceReader& operator=(const BinaryTraceReader& obj);
+
+  // Data Members (m_ prefix)
+  const uint8* m_map_ptr;
+  uint64 m_map_size;
+  const BinaryTraceHeader* m_header_ptr;
+  const BinaryTraceIndexEntry* m_index_ptr;
+  int m_num_blocks;
+
+  NodeID m_node;
+  physical_address_t m_min_address;
+  physical_address_t m_max_address;
+
+  // decoding state of the current block
+  int m_block;
+  Vector<uint8> m_raw;
+  int m_raw_pos;
+  int m_records_left;
+  TraceRecord m_last_record;
+};
+
+#endif //BINARYTRACE_H
@@ -57,7 +57,8 @@
 
 /*
  * Description: Recording cache requests made to a ruby cache at certain
- *              ruby time. Also dump the requests to a gziped file.
+ *              ruby time. Also dump the requests to a gziped file, or to a
+ *              binary trace when the file name ends in ".rbt".
  *
  */
 
@@ -67,12 +68,13 @@
 #include "Global.h"
 #include "NodeID.h"
 #include "CacheRequestType.h"
+#include "HostMemory.h"
 
 template <class TYPE> class PrioHeap;
 class Address;
 class TraceRecord;
 
-class CacheRecorder {
+class CacheRecorder : public HostMemoryReporter {
 public:
   // Constructors
   CacheRecorder();
@@ -85,6 +87,7 @@ public:
   int dumpRecords(string filename);
 
   void print(ostream& out) const;
+  void reportHostMemory() const;
 private:
   // Private Methods
 
@@ -0,0 +1,205 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+
+/*
+ * Description: Binary microarchitectural checkpoints.  A checkpoint
+ *              holds the warmed state of the Ruby caches and
+ *              directories and of pyrite's branch predictors, so a
+ *              run starting from a Simics checkpoint can restore that
+ *              state directly instead of replaying a cache trace
+ *              through the protocol.
+ *
+ *              File layout (host byte order, no padding):
+ *                CheckpointHeader
+ *                the key: the name of the Simics checkpoint this
+ *                  checkpoint accompanies
+ *                sections, each a name followed by its payload
+ *
+ *              Components write their state with the write()
+ *              overloads and read it back in the same order with the
+ *              matching read()/check() calls.  Large tables go
+ *              through writeArray()/readArray() and are copied
+ *              straight out of the mmapped file.
+ *
+ *              Only quiescent state is saved: TBEs, messages and
+ *              outstanding requests are not, so the memory system
+ *              must be drained when a checkpoint is taken.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "Global.h"
+#include "Vector.h"
+#include <stdio.h>
+#include <string.h>
+
+class Address;
+class DataBlock;
+class Set;
+class NetDest;
+
+const uint32 CHECKPOINT_VERSION = 2;
+
+struct CheckpointHeader {
+  char m_magic[8];          // "RUBYCKP" plus a NUL
+  uint32 m_version;
+  uint32 m_byte_order;      // CHECKPOINT_BYTE_ORDER as seen by the writer
+  uint32 m_data_bytes;      // bytes per DataBlock, 0 for a NO_STORAGE build
+  uint32 m_key_length;
+};
+
+class CheckpointWriter {
+public:
+  // Constructors
+  CheckpointWriter();
+
+  // Destructor
+  ~CheckpointWriter();
+
+  // Public Methods
+  bool open(const string& filename, const string& key);
+  void close();
+  bool isOpen() const { return m_file != NULL; }
+
+  // Start a named section; the reader must ask for the same name
+  void beginSection(const string& name);
+
+  void write(bool value);
+  void write(int value);
+  void write(int64 value);
+  void write(uint64 value);
+  void write(const string& value);
+  void write(const Address& value);
+  void write(const DataBlock& value);
+  void write(const Set& value);
+  void write(const NetDest& value);
+  void writeBytes(const void* data, uint64 size);
+
+  // Element count followed by the raw elements, for plain-old-data types
+  template <class TYPE> void writeArray(const TYPE* data, int size);
+  template <class TYPE> void writeArray(const Vector<TYPE>& vec);
+private:
+  // Private copy constructor and assignment operator
+  CheckpointWriter(const CheckpointWriter& obj);
+  CheckpointWriter& operator=(const CheckpointWriter& obj);
+
+  // Data Members (m_ prefix)
+  FILE* m_file;
+  string m_filename;
+};
+
+class CheckpointReader {
+public:
+  // Constructors
+  CheckpointReader();
+
+  // Destructor
+  ~CheckpointReader();
+
+  // Public Methods
+
+  // Map a checkpoint.  Returns false if the file can not be read;
+  // ERROR_MSGs if it is not a checkpoint of this version or was
+  // taken with a different key.
+  bool open(const string& filename, const string& key);
+  void close();
+  bool isOpen() const { return m_map_ptr != NULL; }
+
+  // ERROR_MSGs unless the next section has this name
+  void beginSection(const string& name);
+
+  void read(bool& value);
+  void read(int& value);
+  void read(int64& value);
+  void read(uint64& value);
+  void read(string& value);
+  void read(Address& value);
+  void read(DataBlock& value);
+  void read(Set& value);
+  void read(NetDest& value);
+  const uint8* readBytes(uint64 size);  // points into the mapped file
+
+  // An enumeration written as an int, ERROR_MSG if out of range
+  int readEnum(int num_values);
+
+  // Read a value written with write() of the same type and ERROR_MSG
+  // if it differs, e.g. for the geometry of a table
+  void check(int expected, const string& what);
+  void check(int64 expected, const string& what);
+  void check(const string& expected, const string& what);
+
+  // The array must already have the size it was written with
+  template <class TYPE> void readArray(TYPE* data, int size);
+  template <class TYPE> void readArray(Vector<TYPE>& vec);
+private:
+  // Private copy constructor and assignment operator
+  CheckpointReader(const CheckpointReader& obj);
+  CheckpointReader& operator=(const CheckpointReader& obj);
+
+  // Data Members (m_ prefix)
+  const uint8* m_map_ptr;
+  uint64 m_map_size;
+  uint64 m_pos;
+  int m_data_bytes;
+  string m_filename;
+};
+
+// ******************* Definitions *******************
+
+template <class TYPE>
+inline
+void CheckpointWriter::writeArray(const TYPE* data, int size)
+{
+  write(size);
+  writeBytes(data, uint64(size) * sizeof(TYPE));
+}
+
+template <class TYPE>
+inline
+void CheckpointWriter::writeArray(const Vector<TYPE>& vec)
+{
+  if (vec.size() == 0) {
+    write(0);
+  } else {
+    writeArray(&vec[0], vec.size());
+  }
+}
+
+template <class TYPE>
+inline
+void CheckpointReader::readArray(TYPE* data, int size)
+{
+  check(size, "array size");
+  memcpy(data, readBytes(uint64(size) * sizeof(TYPE)), uint64(size) * sizeof(TYPE));
+}
+
+template <class TYPE>
+inline
+void CheckpointReader::readArray(Vector<TYPE>& vec)
+{
+  if (vec.size() == 0) {
+    check(0, "array size");
+  } else {
+    readArray(&vec[0], vec.size());
+  }
+}
+
+#endif //CHECKPOINT_H
@@ -88,6 +88,12 @@ public:
   bool node_less_then_eq(const TraceRecord& rec) const { return (this->m_time <= rec.m_time); }
   void issueRequest() const;
 
+  NodeID getNodeNum() const { return m_node_num; }
+  Time getTime() const { return m_time; }
+  const Address& getDataAddress() const { return m_data_address; }
+  const Address& getPCAddress() const { return m_pc_address; }
+  CacheRequestType getType() const { return m_type; }
+
   void print(ostream& out) const;
   void output(ostream& out) const;
   bool input(istream& in);
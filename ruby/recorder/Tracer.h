@@ -57,7 +57,10 @@
 
 /*
  * Description: Controller class of the tracer. Can stop/start/playback
- *              the ruby cache requests trace.
+ *              the ruby cache requests trace.  Trace files whose name
+ *              ends in ".rbt" use the compact binary format of
+ *              BinaryTrace.h, everything else is gzipped text.
+ *              Playback detects the format from the file itself.
  *
  */
 
@@ -72,6 +75,7 @@
 template <class TYPE> class PrioHeap;
 class Address;
 class TraceRecord;
+class BinaryTraceWriter;
 
 class Tracer {
 public:
@@ -94,9 +98,16 @@ public:
 
   // Public Class Methods
   static Tracer* create() { return new Tracer; }
-  static int playbackTrace(string filename);
+  // Replays the records of one processor (-1 for all) whose data
+  // address lies in [min_address, max_address]
+  static int playbackTrace(string filename, NodeID node = -1, physical_address_t min_address = 0,
+                           physical_address_t max_address = ~physical_address_t(0));
 private:
   // Private Methods
+  static int playbackBinaryTrace(string filename, NodeID node, physical_address_t min_address,
+                                 physical_address_t max_address);
+  static void playbackRecord(const TraceRecord& record, int& counter);
+  static int finishPlayback(time_t start_time, int counter);
 
   // Private copy constructor and assignment operator
   Tracer(const Tracer& obj);
@@ -104,6 +115,7 @@ private:
   
   // Data Members (m_ prefix)
   ogzstream m_trace_file;
+  BinaryTraceWriter* m_binary_trace_ptr;  // NULL when tracing to text
   bool m_enabled;
 };
 
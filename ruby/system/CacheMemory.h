@@ -68,12 +68,15 @@ class DataBlock;
 class CacheEntryBase;
 class Address;
 class CacheRecorder;
+class ReplacementPolicy;
+class CheckpointWriter;
+class CheckpointReader;
 
 class CacheMemory {
 public:
 
   // Constructors
-  CacheMemory(NodeID id, const CacheEntryBase& entry, int numSetBits, int cacheAssoc, const string& description);
+  CacheMemory(NodeID id, const CacheEntryBase& entry, int numSetBits, int cacheAssoc, const string& description, const string& replacementPolicy);
 
   // Destructor
   ~CacheMemory();
@@ -112,6 +115,11 @@ public:
   // Hook for checkpointing the contents of the cache
   void recordCacheContents(CacheRecorder& tr, bool is_instruction_cache) const;
 
+  // Save and restore the tag store, the valid entries and the
+  // replacement state (see Checkpoint.h)
+  void checkpoint(CheckpointWriter& cp) const;
+  void restore(CheckpointReader& cp);
+
   // Set this address to most recently used
   void setMRU(const Address& address);
 
@@ -129,6 +137,9 @@ private:
   // returns -1 if the tag is not found.
   int findTagInSet(Index line, const Address& tag) const;
 
+  // bitmask with one bit set for every way of a set
+  uint64 allWaysMask() const { return (m_cache_assoc == 64) ? ~0ULL : ((1ULL << m_cache_assoc) - 1); }
+
   // Private copy constructor and assignment operator
   CacheMemory(const CacheMemory& obj);
   CacheMemory& operator=(const CacheMemory& obj);
@@ -137,9 +148,15 @@ private:
   NodeID m_id;
   string m_description;
 
-  // The first index is the # of cache lines.
-  // The second index is the the amount associativity.
-  Vector<Vector<CacheEntryBase*> > m_cache;
+  // The tag store is kept apart from the entries so that lookups and
+  // replacement only touch these compact arrays.  All flat arrays are
+  // indexed by (set * m_cache_assoc + way).
+  Vector<physical_address_t> m_tags;
+  Vector<AccessPermission> m_permissions;
+  Vector<uint64> m_valid;  // per set, one bit per way that is not NotPresent
+
+  Vector<CacheEntryBase*> m_entries;
+  ReplacementPolicy* m_replacement_ptr;
 
   int m_cache_num_sets;
   int m_cache_num_set_bits;
@@ -68,16 +68,19 @@
 #include <list>
 #include <queue>
 #include "MemorySystem.h"
+#include "HostMemory.h"
 using namespace std;
 
 class Network; // network 
 class MessageBuffer;
 class Address;
+class CheckpointWriter;
+class CheckpointReader;
 
 #if DRAMSIM
-class DirectoryMemory : public Consumer {
+class DirectoryMemory : public Consumer, public HostMemoryReporter {
 #else
-class DirectoryMemory {
+class DirectoryMemory : public HostMemoryReporter {
 #endif
 public:
   // Constructors
@@ -92,6 +95,11 @@ public:
 
   void printConfig(ostream& out);
   void print(ostream& out) const;
+  void reportHostMemory() const;
+
+  // Save and restore every allocated entry (see Checkpoint.h)
+  void checkpoint(CheckpointWriter& cp) const;
+  void restore(CheckpointReader& cp);
 
   static NodeID mapAddressToHomeNode(const Address& addr);
 
@@ -0,0 +1,156 @@
+// -----------------------------------------------------------------------------
+//
+//  This file is part of FeS2.
+//
+//  FeS2 is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  FeS2 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with FeS2.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+
+// Replacement policies for CacheMemory.  Each policy keeps its own
+// compact per-set state (a few bits per way) so that neither hits nor
+// victim selection need to touch the cache entries themselves.
+//
+// Policies are selected by name:
+//   LRU         - true LRU using log2(assoc) age bits per way
+//   PSEUDO_LRU  - binary tree pseudo-LRU, (assoc - 1) bits per set
+//   NRU         - not-recently-used, one reference bit per way
+//   SRRIP       - static re-reference interval prediction (2-bit RRPV)
+//   BRRIP       - bimodal RRIP, inserts at distant re-reference most of the time
+
+#ifndef REPLACEMENTPOLICY_H
+#define REPLACEMENTPOLICY_H
+
+#include "Global.h"
+#include "Vector.h"
+
+class CheckpointWriter;
+class CheckpointReader;
+
+class ReplacementPolicy {
+public:
+  // Constructors
+  ReplacementPolicy(int num_sets, int assoc) : m_num_sets(num_sets), m_assoc(assoc) { }
+
+  // Destructor
+  virtual ~ReplacementPolicy() { }
+
+  // Public Methods
+
+  // called when a way has been filled with a new block
+  virtual void insert(Index set, int way) { touch(set, way); }
+
+  // called on every hit (and on setMRU)
+  virtual void touch(Index set, int way) = 0;
+
+  // returns the way to be replaced in a full set.  Repeated calls
+  // without an intervening insert/touch return the same way.
+  virtual int getVictim(Index set) const = 0;
+
+  virtual void print(ostream& out) const = 0;
+
+  // save and restore the per-set state (see Checkpoint.h)
+  virtual void checkpoint(CheckpointWriter& cp) const = 0;
+  virtual void restore(CheckpointReader& cp) = 0;
+
+  // Build a policy from its name (see above), ERROR_MSG on unknown names
+  static ReplacementPolicy* create(const string& name, int num_sets, int assoc);
+
+protected:
+  // Data Members (m_ prefix)
+  int m_num_sets;
+  int m_assoc;
+};
+
+class LRUPolicy : public ReplacementPolicy {
+public:
+  LRUPolicy(int num_sets, int assoc);
+
+  void touch(Index set, int way);
+  int getVictim(Index set) const;
+  void print(ostream& out) const { out << "LRU"; }
+  void checkpoint(CheckpointWriter& cp) const;
+  void restore(CheckpointReader& cp);
+
+private:
+  // m_age[set * assoc + way]: 0 is MRU, assoc-1 is LRU
+  Vector<uint8> m_age;
+};
+
+class PseudoLRUPolicy : public ReplacementPolicy {
+public:
+  PseudoLRUPolicy(int num_sets, int assoc);
+
+  void touch(Index set, int way);
+  int getVictim(Index set) const;
+  void print(ostream& out) const { out << "PSEUDO_LRU"; }
+  void checkpoint(CheckpointWriter& cp) const;
+  void restore(CheckpointReader& cp);
+
+private:
+  // one tree per set; bit i is node i of a heap-ordered binary tree,
+  // set when the less recently used (victim) child is on the right
+  Vector<uint64> m_tree;
+  int m_levels;
+};
+
+class NRUPolicy : public ReplacementPolicy {
+public:
+  NRUPolicy(int num_sets, int assoc);
+
+  void touch(Index set, int way);
+  int getVictim(Index set) const;
+  void print(ostream& out) const { out << "NRU"; }
+  void checkpoint(CheckpointWriter& cp) const;
+  void restore(CheckpointReader& cp);
+
+private:
+  // per-set reference bits, one per way
+  Vector<uint64> m_referenced;
+};
+
+class RRIPPolicy : public ReplacementPolicy {
+public:
+  RRIPPolicy(int num_sets, int assoc, bool bimodal);
+
+  void insert(Index set, int way);
+  void touch(Index set, int way);
+  int getVictim(Index set) const;
+  void print(ostream& out) const { out << (m_bimodal ? "BRRIP" : "SRRIP"); }
+  void checkpoint(CheckpointWriter& cp) const;
+  void restore(CheckpointReader& cp);
+
+private:
+  // 2-bit re-reference prediction value per way.  Mutable because
+  // victim selection ages the set.
+  mutable Vector<uint8> m_rrpv;
+  bool m_bimodal;
+  // deterministic 1-in-BRRIP_LONG_INTERVAL throttle for BRRIP insertion
+  int m_insert_count;
+};
+
+// Output operator declaration
+ostream& operator<<(ostream& out, const ReplacementPolicy& obj);
+
+// ******************* Definitions *******************
+
+// Output operator definition
+extern inline
+ostream& operator<<(ostream& out, const ReplacementPolicy& obj)
+{
+  obj.print(out);
+  out << flush;
+  return out;
+}
+
+#endif //REPLACEMENTPOLICY_H
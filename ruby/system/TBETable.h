@@ -79,6 +79,7 @@ public:
   void allocate(const Address& address);
   void deallocate(const Address& address);
   bool areNSlotsAvailable(int n) const { return (g_param_ptr->NUMBER_OF_TBES() - m_map.size()) >= n; }
+  bool isEmpty() const { return m_map.size() == 0; }
 
   EntryBase& lookup(const Address& address);
   const EntryBase& lookup(const Address& address) const;
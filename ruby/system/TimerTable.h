@@ -61,6 +61,7 @@
 #include "Global.h"
 #include "Map.h"
 #include "Address.h"
+#include "Vector.h"
 class Consumer;
 
 class TimerTable {
@@ -75,10 +76,13 @@ public:
   // Public Methods
   void setConsumer(Consumer* consumer_ptr) { ASSERT(m_consumer_ptr==NULL); m_consumer_ptr = consumer_ptr; }
   void setDescription(const string& name) { m_name = name; }
+  // Bit in the consumer's bitmap kept set while any timer is pending
+  void setOccupancyBit(Vector<uint64>* mask_ptr, int bit);
 
   bool isReady() const;
   const Address& readyAddress() const;
   bool isSet(const Address& address) const { return m_map.exist(address); }
+  bool isEmpty() const { return m_map.size() == 0; }
   void set(const Address& address, Time relative_latency);
   void unset(const Address& address);
 
@@ -87,6 +91,13 @@ public:
 private:
   // Private Methods
   void updateNext() const;
+  void setOccupied(bool occupied) {
+    if (m_occupancy_mask_ptr != NULL) {
+      uint64& word = (*m_occupancy_mask_ptr)[m_occupancy_bit >> 6];
+      uint64 bit = 1ULL << (m_occupancy_bit & 63);
+      word = occupied ? (word | bit) : (word & ~bit);
+    }
+  }
 
   // Private copy constructor and assignment operator
   TimerTable(const TimerTable& obj);
@@ -98,6 +109,8 @@ private:
   mutable Time m_next_time; // Only valid if m_next_valid is true
   mutable Address m_next_address;  // Only valid if m_next_valid is true
   Consumer* m_consumer_ptr;  // Consumer to signal a wakeup()
+  Vector<uint64>* m_occupancy_mask_ptr;  // Consumer's non-empty bitmap, can be NULL
+  int m_occupancy_bit;
   string m_name;
 };
 
@@ -62,4 +62,7 @@
 class DeclListAST;
 extern DeclListAST* g_decl_list_ptr;
 
+// --fast: table-driven transitions with profiling compiled out
+extern bool g_fast_mode;
+
 #endif //MAIN_H
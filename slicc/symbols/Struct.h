@@ -84,6 +84,7 @@ private:
 
   void printTypeH(string path) const;
   void printTypeC(string path) const;
+  bool isCheckpointed() const;
 
   // Private copy constructor and assignment operator
   Struct(const Struct& obj);
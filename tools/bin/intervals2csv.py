@@ -0,0 +1,87 @@
+#!/usr/bin/python
+
+from optparse import OptionParser
+import json
+import struct
+import sys
+
+descripText = """Converts a pyrite interval stats file (see pyrite/IntervalStats.h),
+binary or JSON lines, into CSV on stdout: one row per interval, the cycle
+followed by the delta of every stat."""
+
+MAGIC = b"PYRITIV\0"
+HEADER = struct.Struct( "=8sIIQ" )
+
+def readJson( f ):
+    """Returns (fields, rows) of a .jsonl interval file"""
+    header = json.loads( f.readline() )
+    rows = [ json.loads( line ) for line in f if line.strip() != "" ]
+    return header['fields'], rows
+
+def readBinary( f ):
+    """Returns (fields, rows) of a binary interval file"""
+    data = f.read()
+    magic, version, numFields, interval = HEADER.unpack_from( data, 0 )
+    assert magic == MAGIC, "not a pyrite interval stats file"
+    assert version == 1, "unknown interval stats version %d" % version
+    offset = HEADER.size
+    fields = [ "cycle" ]
+    for i in range( numFields ):
+        end = data.index( b"\0", offset )
+        fields.append( data[offset:end].decode() )
+        offset = end + 1
+    record = struct.Struct( "=%dq" % (numFields + 1) )
+    rows = []
+    # a record still being written when the file was copied is dropped
+    while offset + record.size <= len( data ):
+        rows.append( record.unpack_from( data, offset ) )
+        offset += record.size
+    return fields, rows
+
+parser = OptionParser( usage="%prog [options] intervals-file",
+                       description=descripText )
+parser.add_option( "-f", "--fields", dest="fields", default="",
+                   help="comma-separated stat names to keep; a name without a '.N' "
+                        "processor suffix keeps every processor (default: all)" )
+parser.add_option( "-c", "--cpi", dest="cpi", action="store_true", default=False,
+                   help="print the CPI stack of every processor instead: each cpi* "
+                        "stat divided by the x86 instructions committed in the interval" )
+opts, args = parser.parse_args()
+assert len(args) == 1, "Incorrect usage: run with --help for usage info."
+
+f = open( args[0], "rb" )
+if f.read( len(MAGIC) ) == MAGIC:
+    f.seek( 0 )
+    fields, rows = readBinary( f )
+else:
+    f.close()
+    f = open( args[0], "r" )
+    fields, rows = readJson( f )
+f.close()
+
+def cpiStack( fields, rows ):
+    """Returns (fields, rows) with the cpi* stats turned into CPI"""
+    index = dict( [ (fields[i], i) for i in range( len(fields) ) ] )
+    columns = [ i for i in range( 1, len(fields) ) if fields[i].startswith( "cpi" ) ]
+    instructions = [ index["correctlyExecutedX86Instructions." + fields[i].split( "." )[1]]
+                     for i in columns ]
+    cpiRows = []
+    for row in rows:
+        cpiRow = [ row[0] ]
+        for i, insns in zip( columns, instructions ):
+            cpiRow.append( "%.4f" % (float( row[i] ) / row[insns]) if row[insns] > 0 else "" )
+        cpiRows.append( cpiRow )
+    return [ fields[0] ] + [ fields[i] for i in columns ], cpiRows
+
+if opts.cpi:
+    fields, rows = cpiStack( fields, rows )
+
+columns = range( len(fields) )
+if opts.fields != "":
+    wanted = opts.fields.split( "," )
+    columns = [ 0 ] + [ i for i in range( 1, len(fields) )
+                        if fields[i] in wanted or fields[i].split( "." )[0] in wanted ]
+
+sys.stdout.write( ",".join( [ fields[i] for i in columns ] ) + "\n" )
+for row in rows:
+    sys.stdout.write( ",".join( [ str( row[i] ) for i in columns ] ) + "\n" )